@@ -17,6 +17,8 @@ namespace browser_driver {
 // Defaults: disable_translate true, so the translate bar is hidden unless opted in.
 struct OpenBrowserOptions {
     bool disable_translate = true;
+    bool new_instance = false; // launch an additional pooled browser instead of reusing the open one
+    int pool_index = 0;        // set by the driver: pooled instances > 0 get their own profile directory
 };
 
 // Information about a single browser tab / target.
@@ -25,6 +27,8 @@ struct TabInfo {
     std::string title;
     std::string url;
     std::string type; // e.g. "page", "background_page", "service_worker"
+    std::string browser_context_id; // isolated context the tab lives in; empty = default context
+    int browser_index = 0; // pooled browser instance the tab belongs to
     bool is_current = false; // true if this tab is the one currently attached for commands
 };
 
@@ -35,6 +39,14 @@ struct DriverResult {
     std::string error_detail;
 };
 
+// Result of creating an isolated browser context (own cookies, storage and cache).
+struct CreateBrowserContextResult {
+    bool success = false;
+    std::string browser_context_id;
+    std::string message;
+    std::string error_detail;
+};
+
 // Result of listing tabs.
 struct TabListResult {
     bool success = false;
@@ -47,19 +59,74 @@ struct NavigateResult {
     bool success = false;
     std::string frame_id;
     std::string error_text; // CDP errorText if navigation failed
+    std::string reached;    // lifecycle milestone waited for (empty = did not wait)
+    int elapsed_milliseconds = 0;
 };
 
 // Options for capture_screenshot. Caller chooses format; default JPEG 70 to keep payload small.
 struct CaptureScreenshotOptions {
-    std::string format = "jpeg";  // "png" or "jpeg"
-    int quality = 70;              // 1–100, only for jpeg; lower = smaller file
+    std::string format = "jpeg";  // "png", "jpeg" or "webp"
+    int quality = 70;              // 1–100, only for jpeg and webp; lower = smaller file
+    // Region in CSS pixels from the viewport's top-left; width or height 0 = whole viewport.
+    double clip_x = 0;
+    double clip_y = 0;
+    double clip_width = 0;
+    double clip_height = 0;
+    std::string selector;          // element screenshot (its border box); overrides the clip
+    double scale = 1.0;            // downsampling factor, (0, 1]
+    int max_width = 0;             // cap on output image pixels; 0 = no cap. Lowers the scale to fit.
+    int max_height = 0;
+    // Payload limit in base64 bytes (0 = the CDP rx buffer size, also the upper bound). Larger
+    // captures are re-encoded (PNG as WebP, lower quality, then downscaled) until they fit.
+    int max_bytes = 0;
+    // "capture" (default): render a new image. "latest": newest frame of a screencast kept running on
+    // the tab (started on first use; format, quality and max_width/max_height apply), without a
+    // render round trip. "stop": stop that screencast.
+    std::string mode = "capture";
+    int every_nth_frame = 6;       // screencast: send every n-th compositor frame
+    // Compare with the previous changes_only capture of the tab: report no change, or return only
+    // crops of the changed areas (the full image for the first capture or large changes).
+    bool changes_only = false;
+    // Whole scrollable page, captured as tiles of tile_height CSS pixels (0 = viewport height) one
+    // after another. With output_directory the tiles are written there as files instead of returned.
+    bool full_page = false;
+    int tile_height = 0;
+    std::string output_directory;
+};
+
+// One part of a changes_only capture (a changed area, in the full screenshot's pixels) or of a
+// full_page capture (a tile, in page CSS pixels).
+struct ScreenshotRegion {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    std::string image_base64;
+    std::string file_path;           // full_page with output_directory: written here, no image data
 };
 
 // Result of capturing a screenshot of the current tab.
 struct CaptureScreenshotResult {
     bool success = false;
     std::string image_base64;
-    std::string mime_type;   // e.g. "image/png", "image/jpeg"
+    std::string mime_type;   // e.g. "image/png", "image/jpeg", "image/webp"
+    int quality = 0;         // quality used (0 for png)
+    double scale = 1.0;      // downscale factor used
+    bool adapted = false;    // re-encoded to fit the byte limit
+    bool from_screencast = false;
+    int frame_age_milliseconds = 0;  // screencast frame: time since the page last painted it
+    // changes_only: unchanged = identical to the previous capture (no image); otherwise either
+    // changed_regions (PNG crops of the compared frame) or the full image in image_base64.
+    bool unchanged = false;
+    std::vector<ScreenshotRegion> changed_regions;
+    int full_width = 0;              // changes_only: size of the full image in pixels, as the client gets it
+    int full_height = 0;
+    // full_page: page size in CSS pixels and the tiles in page order; truncated = the tile or byte
+    // limit stopped the capture before the bottom of the page.
+    double page_width = 0;
+    double page_height = 0;
+    std::vector<ScreenshotRegion> tiles;
+    bool truncated = false;
     std::string error_detail;
 };
 
@@ -164,6 +231,12 @@ struct InteractiveElement {
 struct ListInteractiveElementsResult {
     bool success = false;
     std::vector<InteractiveElement> elements;
+    std::string version_token;                  // pass back as since_token to get only changes
+    bool is_delta = false;                      // elements/removed_selectors are changes since the token
+    bool truncated = false;                     // more elements than the per-call maximum
+    std::vector<std::string> removed_selectors; // delta only: handles that were removed or hidden
+    int total_count = 0;                        // snapshot listing: elements across all pages
+    int next_cursor = -1;                       // snapshot listing: cursor of the next page, -1 = last page
     std::string error_detail;
 };
 
@@ -218,6 +291,52 @@ struct GetPageSourceResult {
     std::string error_detail;
 };
 
+// Readable page text (get_page_text): one slice of the markdown text.
+struct GetPageTextResult {
+    bool success = false;
+    std::string text;
+    int next_cursor = -1;   // cursor of the next slice, -1 = end of text
+    int total_length = 0;   // length of the whole text (cursor units)
+    std::string error_detail;
+};
+
+// Accessibility outline (get_accessibility_tree): one line per node, "- role "name" [states] @handle".
+struct GetAccessibilityTreeResult {
+    bool success = false;
+    std::string outline;
+    int line_count = 0;
+    bool truncated = false;  // stopped at the line limit
+    std::string error_detail;
+};
+
+// One field for fill_form. value is the text, the option value or label of a select, or the value
+// of the radio to pick; values lists the options of a multi-select; is_boolean sets a checkbox or
+// radio to checked. type_text types with Input.insertText (keyboard-driven widgets) instead of
+// setting the value.
+struct FormField {
+    std::string selector;
+    std::string value;
+    std::vector<std::string> values;
+    bool is_boolean = false;
+    bool checked = false;
+    bool type_text = false;
+};
+
+struct FillFormFieldResult {
+    std::string selector;
+    bool success = false;
+    bool typed = false;  // filled through Input.insertText
+    std::string error_detail;
+};
+
+// fill_form: per-field outcome in request order.
+struct FillFormResult {
+    bool success = false;  // the form call ran; individual fields may still have failed
+    int filled_count = 0;
+    std::vector<FillFormFieldResult> fields;
+    std::string error_detail;
+};
+
 // Element bounding box (getBoundingClientRect).
 struct BoundingBoxResult {
     bool success = false;
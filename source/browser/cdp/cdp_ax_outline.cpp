@@ -0,0 +1,274 @@
+#include "browser/cdp/cdp_ax_outline.hpp"
+
+#include <map>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace cdp_ax_outline {
+
+static constexpr int kMaxDepth = 256;
+
+// One AXNode reduced to what the outline needs.
+struct OutlineNode {
+    std::string role;
+    std::string name;
+    std::string value;
+    bool ignored = false;
+    bool focusable = false;
+    int backend_node_id = 0;
+    std::vector<std::string> states;
+    std::vector<int> children;
+    bool keep = true;  // in scope of the viewport filter (itself or a descendant)
+};
+
+static std::string ax_value_string(const json &holder, const char *key) {
+    if (!holder.contains(key) || !holder[key].is_object() || !holder[key].contains("value")) {
+        return "";
+    }
+    const json &value = holder[key]["value"];
+    if (value.is_string()) {
+        return value.get<std::string>();
+    }
+    if (value.is_number() || value.is_boolean()) {
+        return value.dump();
+    }
+    return "";
+}
+
+// Roles that get a handle; other nodes only when focusable.
+static bool is_interactive_role(const std::string &role) {
+    static const char *const kRoles[] = {
+        "button", "link", "textbox", "searchbox", "checkbox", "radio", "combobox", "listbox", "option",
+        "menuitem", "menuitemcheckbox", "menuitemradio", "tab", "switch", "slider", "spinbutton", "treeitem"};
+    for (const char *interactive_role : kRoles) {
+        if (role == interactive_role) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Containers that carry no meaning without a name; their children are lifted.
+static bool is_transparent_role(const std::string &role) {
+    return role == "generic" || role == "none" || role == "presentation" || role == "GenericContainer" ||
+           role == "InlineTextBox" || role == "LineBreak" || role.empty();
+}
+
+static OutlineNode read_node(const json &node) {
+    OutlineNode outline_node;
+    outline_node.role = ax_value_string(node, "role");
+    outline_node.name = ax_value_string(node, "name");
+    outline_node.value = ax_value_string(node, "value");
+    outline_node.ignored = node.value("ignored", false);
+    outline_node.backend_node_id = node.value("backendDOMNodeId", 0);
+    if (!node.contains("properties") || !node["properties"].is_array()) {
+        return outline_node;
+    }
+    for (const auto &property : node["properties"]) {
+        std::string property_name = property.value("name", "");
+        std::string value = ax_value_string(property, "value");
+        if (property_name == "focusable") {
+            outline_node.focusable = (value == "true");
+        } else if (property_name == "focused" || property_name == "disabled" || property_name == "selected" ||
+                   property_name == "required" || property_name == "readonly" || property_name == "modal" ||
+                   property_name == "multiselectable") {
+            if (value == "true") {
+                outline_node.states.push_back(property_name);
+            }
+        } else if (property_name == "checked" || property_name == "pressed") {
+            if (value == "true") {
+                outline_node.states.push_back(property_name);
+            } else if (value == "mixed") {
+                outline_node.states.push_back(property_name + "=mixed");
+            }
+        } else if (property_name == "expanded") {
+            outline_node.states.push_back(value == "true" ? "expanded" : "collapsed");
+        } else if (property_name == "invalid") {
+            if (!value.empty() && value != "false") {
+                outline_node.states.push_back("invalid");
+            }
+        } else if (property_name == "level") {
+            outline_node.states.push_back("level=" + value);
+        }
+    }
+    return outline_node;
+}
+
+// Quoted, newline-free, length-capped name. The cap counts UTF-8 characters and only cuts before a
+// lead byte, so a multi-byte character is never split (the outline must stay valid UTF-8 for JSON).
+static std::string quoted(const std::string &text, size_t max_length) {
+    std::string out = "\"";
+    size_t length = 0;
+    bool last_space = false;
+    for (char character : text) {
+        bool continuation = (static_cast<unsigned char>(character) & 0xC0) == 0x80;
+        if (continuation) {
+            out.push_back(character);
+            continue;
+        }
+        if (length >= max_length) {
+            out += "...";
+            break;
+        }
+        if (character == '\n' || character == '\r' || character == '\t' || character == ' ') {
+            if (last_space) {
+                continue;
+            }
+            character = ' ';
+            last_space = true;
+        } else {
+            last_space = false;
+        }
+        if (character == '"' || character == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(character);
+        ++length;
+    }
+    out.push_back('"');
+    return out;
+}
+
+struct OutlineWriter {
+    std::vector<OutlineNode> &nodes;
+    const AxOutlineOptions &options;
+    AxOutline &outline;
+
+    void write(int index, int depth, const std::string &parent_name) {
+        if (outline.truncated || depth > kMaxDepth) {
+            return;
+        }
+        const OutlineNode &node = nodes[index];
+        if (!node.keep) {
+            return;
+        }
+        bool transparent = node.ignored || (is_transparent_role(node.role) && node.name.empty());
+        if (transparent) {
+            for (int child : node.children) {
+                write(child, depth, parent_name);
+            }
+            return;
+        }
+        if (node.role == "StaticText") {
+            if (node.name.empty() || node.name == parent_name) {
+                return;
+            }
+            add_line(depth, "- text " + quoted(node.name, options.max_name_length));
+            return;
+        }
+
+        std::string line = "- " + node.role;
+        if (!node.name.empty()) {
+            line += " " + quoted(node.name, options.max_name_length);
+        }
+        if (!node.states.empty()) {
+            line += " [";
+            for (size_t state = 0; state < node.states.size(); ++state) {
+                line += (state > 0 ? ", " : "") + node.states[state];
+            }
+            line += "]";
+        }
+        if (!node.value.empty() && node.value != node.name) {
+            line += ": " + quoted(node.value, options.max_name_length);
+        }
+        if (node.backend_node_id > 0 && (node.focusable || is_interactive_role(node.role))) {
+            line += " @n" + std::to_string(node.backend_node_id);
+        }
+        add_line(depth, line);
+
+        // A single text child repeating the name adds nothing.
+        for (int child : node.children) {
+            write(child, depth + 1, node.name);
+        }
+    }
+
+    void add_line(int depth, const std::string &line) {
+        if (outline.line_count >= options.max_lines) {
+            outline.truncated = true;
+            return;
+        }
+        outline.text.append(static_cast<size_t>(depth) * 2, ' ');
+        outline.text += line;
+        outline.text.push_back('\n');
+        ++outline.line_count;
+    }
+};
+
+// Mark nodes that are visible or have a visible descendant (iterative post-order).
+static bool mark_kept(std::vector<OutlineNode> &nodes, int root, const std::unordered_set<int> &visible) {
+    std::vector<std::pair<int, size_t>> stack = {{root, 0}};
+    std::vector<bool> visited(nodes.size(), false);
+    visited[root] = true;
+    for (auto &node : nodes) {
+        node.keep = false;
+    }
+    while (!stack.empty()) {
+        int index = stack.back().first;
+        size_t &next_child = stack.back().second;
+        if (next_child < nodes[index].children.size()) {
+            int child = nodes[index].children[next_child++];
+            if (!visited[child]) {
+                visited[child] = true;
+                stack.push_back({child, 0});
+            }
+            continue;
+        }
+        OutlineNode &node = nodes[index];
+        node.keep = node.keep || (node.backend_node_id > 0 && visible.count(node.backend_node_id) > 0);
+        stack.pop_back();
+        if (node.keep && !stack.empty()) {
+            nodes[stack.back().first].keep = true;
+        }
+    }
+    return nodes[root].keep;
+}
+
+AxOutline format_ax_outline(const json &ax_nodes, const AxOutlineOptions &options) {
+    AxOutline outline;
+    if (!ax_nodes.is_array() || ax_nodes.empty()) {
+        return outline;
+    }
+
+    std::vector<OutlineNode> nodes;
+    nodes.reserve(ax_nodes.size());
+    std::map<std::string, int> index_by_id;
+    std::vector<bool> has_parent(ax_nodes.size(), false);
+    for (const auto &ax_node : ax_nodes) {
+        index_by_id[ax_node.value("nodeId", "")] = static_cast<int>(nodes.size());
+        nodes.push_back(read_node(ax_node));
+    }
+    for (size_t index = 0; index < ax_nodes.size(); ++index) {
+        if (!ax_nodes[index].contains("childIds") || !ax_nodes[index]["childIds"].is_array()) {
+            continue;
+        }
+        for (const auto &child_id : ax_nodes[index]["childIds"]) {
+            auto child = child_id.is_string() ? index_by_id.find(child_id.get<std::string>()) : index_by_id.end();
+            if (child != index_by_id.end() && child->second != static_cast<int>(index)) {
+                nodes[index].children.push_back(child->second);
+                has_parent[child->second] = true;
+            }
+        }
+    }
+
+    int root = -1;
+    for (size_t index = 0; index < nodes.size() && root < 0; ++index) {
+        if (options.root_backend_node_id > 0 ? nodes[index].backend_node_id == options.root_backend_node_id
+                                             : !has_parent[index]) {
+            root = static_cast<int>(index);
+        }
+    }
+    if (root < 0) {
+        return outline;
+    }
+    outline.root_found = true;
+
+    if (options.visible_backend_node_ids && !mark_kept(nodes, root, *options.visible_backend_node_ids)) {
+        return outline;
+    }
+    OutlineWriter writer{nodes, options, outline};
+    writer.write(root, 0, "");
+    return outline;
+}
+
+} // namespace cdp_ax_outline
@@ -0,0 +1,34 @@
+#ifndef BMCPS_CDP_AX_OUTLINE_HPP
+#define BMCPS_CDP_AX_OUTLINE_HPP
+
+// Compact text outline of an accessibility tree (Accessibility.getFullAXTree nodes).
+// One line per meaningful node: "- role "name" [states] @n<backendNodeId>", indented by depth.
+// Ignored nodes and unnamed generic containers are pruned (their children move up),
+// text already carried by the parent's name is dropped.
+
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_set>
+
+namespace cdp_ax_outline {
+
+struct AxOutlineOptions {
+    int root_backend_node_id = 0;                             // 0 = the document root
+    const std::unordered_set<int> *visible_backend_node_ids = nullptr;  // null = no viewport filter
+    int max_lines = 2000;
+    size_t max_name_length = 100;                             // in UTF-8 characters
+};
+
+struct AxOutline {
+    bool root_found = false;
+    std::string text;
+    int line_count = 0;
+    bool truncated = false;  // stopped at max_lines
+};
+
+// nodes: the "nodes" array of Accessibility.getFullAXTree.
+AxOutline format_ax_outline(const nlohmann::json &nodes, const AxOutlineOptions &options = {});
+
+} // namespace cdp_ax_outline
+
+#endif // BMCPS_CDP_AX_OUTLINE_HPP
@@ -166,6 +166,9 @@ ChromeLaunchResult launch_chrome(const browser_driver::OpenBrowserOptions &optio
     debug_log::log("Chrome launch starting…");
 
     std::string profile_directory = "/tmp/bmcps_chrome_profile_" + std::to_string(getpid());
+    if (options.pool_index > 0) {
+        profile_directory += "_" + std::to_string(options.pool_index);
+    }
     std::filesystem::create_directories(profile_directory);
     result.user_data_directory = profile_directory;
 
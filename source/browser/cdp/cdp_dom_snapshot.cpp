@@ -0,0 +1,448 @@
+#include "browser/cdp/cdp_dom_snapshot.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <map>
+#include <utility>
+
+using json = nlohmann::json;
+
+namespace cdp_dom_snapshot {
+
+static constexpr size_t kTextMax = 200;
+static constexpr int kNodeTypeElement = 1;
+static constexpr int kNodeTypeText = 3;
+
+// Fallbacks for missing snapshot fields, so lookups bind references instead of copying.
+static const json kEmptyArray = json::array();
+static const json kEmptyObject = json::object();
+
+// Box of a layout object: document coordinates in the snapshot, viewport coordinates after offsetting.
+struct Box {
+    double x = 0;
+    double y = 0;
+    double width = 0;
+    double height = 0;
+};
+
+// One DocumentSnapshot unpacked into per-node vectors (node index = position).
+struct DocumentNodes {
+    std::vector<int> parent;
+    std::vector<int> node_type;
+    std::vector<std::string> node_name;
+    std::vector<int> backend_node_id;
+    std::vector<std::vector<std::pair<std::string, std::string>>> attributes;
+    std::vector<int> layout_index;  // -1 = no layout object (not rendered)
+    std::vector<Box> boxes;         // by layout index
+    std::vector<bool> hidden_style; // by layout index: visibility hidden/collapse
+    double scroll_x = 0;
+    double scroll_y = 0;
+    int owner_document = -1;        // document holding the frame element, -1 = top level
+    int owner_node = -1;
+};
+
+std::vector<std::string> required_computed_styles() {
+    return {"visibility"};
+}
+
+static std::string lookup_string(const json &strings, const json &index_value) {
+    if (!index_value.is_number_integer()) {
+        return "";
+    }
+    int index = index_value.get<int>();
+    if (index < 0 || index >= static_cast<int>(strings.size()) || !strings[index].is_string()) {
+        return "";
+    }
+    return strings[index].get<std::string>();
+}
+
+static int int_at(const json &array, size_t index, int fallback) {
+    if (!array.is_array() || index >= array.size() || !array[index].is_number_integer()) {
+        return fallback;
+    }
+    return array[index].get<int>();
+}
+
+static std::string to_lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+    return text;
+}
+
+// Append text with whitespace runs collapsed to one space, keeping the result under kTextMax.
+// The cut only happens before a UTF-8 lead byte, so a multi-byte character is never split.
+static void append_collapsed(std::string &target, const std::string &text) {
+    for (char character : text) {
+        bool continuation = (static_cast<unsigned char>(character) & 0xC0) == 0x80;
+        if (target.size() >= kTextMax && !continuation) {
+            return;
+        }
+        if (std::isspace(static_cast<unsigned char>(character))) {
+            if (!target.empty() && target.back() != ' ') {
+                target.push_back(' ');
+            }
+        } else {
+            target.push_back(character);
+        }
+    }
+}
+
+static std::string trimmed(const std::string &text) {
+    size_t begin = text.find_first_not_of(' ');
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(' ');
+    return text.substr(begin, end - begin + 1);
+}
+
+static DocumentNodes unpack_document(const json &document, const json &strings) {
+    DocumentNodes unpacked;
+    const json &nodes = document.contains("nodes") ? document["nodes"] : kEmptyObject;
+    const json &parent_index = nodes.contains("parentIndex") ? nodes["parentIndex"] : kEmptyArray;
+    const json &node_type = nodes.contains("nodeType") ? nodes["nodeType"] : kEmptyArray;
+    const json &node_name = nodes.contains("nodeName") ? nodes["nodeName"] : kEmptyArray;
+    const json &backend_node_id = nodes.contains("backendNodeId") ? nodes["backendNodeId"] : kEmptyArray;
+    const json &attributes = nodes.contains("attributes") ? nodes["attributes"] : kEmptyArray;
+
+    size_t node_count = node_type.is_array() ? node_type.size() : 0;
+    unpacked.parent.resize(node_count, -1);
+    unpacked.node_type.resize(node_count, 0);
+    unpacked.node_name.resize(node_count);
+    unpacked.backend_node_id.resize(node_count, 0);
+    unpacked.attributes.resize(node_count);
+    unpacked.layout_index.resize(node_count, -1);
+    for (size_t node = 0; node < node_count; ++node) {
+        unpacked.parent[node] = int_at(parent_index, node, -1);
+        unpacked.node_type[node] = int_at(node_type, node, 0);
+        unpacked.backend_node_id[node] = int_at(backend_node_id, node, 0);
+        if (unpacked.node_type[node] != kNodeTypeElement) {
+            continue;
+        }
+        if (node_name.is_array() && node < node_name.size()) {
+            unpacked.node_name[node] = lookup_string(strings, node_name[node]);
+            std::transform(unpacked.node_name[node].begin(), unpacked.node_name[node].end(),
+                           unpacked.node_name[node].begin(),
+                           [](unsigned char character) { return static_cast<char>(std::toupper(character)); });
+        }
+        if (attributes.is_array() && node < attributes.size() && attributes[node].is_array()) {
+            const json &flat = attributes[node];
+            for (size_t pair = 0; pair + 1 < flat.size(); pair += 2) {
+                unpacked.attributes[node].emplace_back(to_lower(lookup_string(strings, flat[pair])),
+                                                       lookup_string(strings, flat[pair + 1]));
+            }
+        }
+    }
+
+    if (document.contains("layout") && document["layout"].is_object()) {
+        const json &layout = document["layout"];
+        const json &layout_node_index = layout.contains("nodeIndex") ? layout["nodeIndex"] : kEmptyArray;
+        const json &bounds = layout.contains("bounds") ? layout["bounds"] : kEmptyArray;
+        const json &styles = layout.contains("styles") ? layout["styles"] : kEmptyArray;
+        size_t layout_count = layout_node_index.is_array() ? layout_node_index.size() : 0;
+        unpacked.boxes.resize(layout_count);
+        unpacked.hidden_style.resize(layout_count, false);
+        for (size_t layout_entry = 0; layout_entry < layout_count; ++layout_entry) {
+            int node = int_at(layout_node_index, layout_entry, -1);
+            if (node >= 0 && node < static_cast<int>(node_count) && unpacked.layout_index[node] < 0) {
+                unpacked.layout_index[node] = static_cast<int>(layout_entry);
+            }
+            if (bounds.is_array() && layout_entry < bounds.size() && bounds[layout_entry].is_array() &&
+                bounds[layout_entry].size() >= 4) {
+                const json &rectangle = bounds[layout_entry];
+                Box &box = unpacked.boxes[layout_entry];
+                box.x = rectangle[0].is_number() ? rectangle[0].get<double>() : 0;
+                box.y = rectangle[1].is_number() ? rectangle[1].get<double>() : 0;
+                box.width = rectangle[2].is_number() ? rectangle[2].get<double>() : 0;
+                box.height = rectangle[3].is_number() ? rectangle[3].get<double>() : 0;
+            }
+            if (styles.is_array() && layout_entry < styles.size() && styles[layout_entry].is_array() &&
+                !styles[layout_entry].empty()) {
+                std::string visibility = lookup_string(strings, styles[layout_entry][0]);
+                unpacked.hidden_style[layout_entry] = (visibility == "hidden" || visibility == "collapse");
+            }
+        }
+    }
+
+    unpacked.scroll_x = document.value("scrollOffsetX", 0.0);
+    unpacked.scroll_y = document.value("scrollOffsetY", 0.0);
+    return unpacked;
+}
+
+static std::string attribute_of(const DocumentNodes &document, int node, const std::string &name) {
+    for (const auto &attribute : document.attributes[node]) {
+        if (attribute.first == name) {
+            return attribute.second;
+        }
+    }
+    return "";
+}
+
+static bool has_attribute(const DocumentNodes &document, int node, const std::string &name) {
+    for (const auto &attribute : document.attributes[node]) {
+        if (attribute.first == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_interactive(const DocumentNodes &document, int node) {
+    if (document.node_type[node] != kNodeTypeElement) {
+        return false;
+    }
+    const std::string &name = document.node_name[node];
+    if (name == "INPUT" || name == "TEXTAREA" || name == "BUTTON" || name == "A" || name == "OPTION") {
+        return true;
+    }
+    std::string role = attribute_of(document, node, "role");
+    return role == "button" || role == "option";
+}
+
+// Rendered with a non-empty box and not visibility:hidden.
+static bool has_visible_box(const DocumentNodes &document, int node) {
+    int layout_entry = document.layout_index[node];
+    if (layout_entry < 0) {
+        return false;
+    }
+    const Box &box = document.boxes[layout_entry];
+    return box.width > 0 && box.height > 0 && !document.hidden_style[layout_entry];
+}
+
+static int closest_ancestor_named(const DocumentNodes &document, int node, const std::string &name) {
+    for (int ancestor = document.parent[node]; ancestor >= 0; ancestor = document.parent[ancestor]) {
+        if (document.node_name[ancestor] == name) {
+            return ancestor;
+        }
+    }
+    return -1;
+}
+
+// All documents of a snapshot, with frame documents linked to their owner element.
+static std::vector<DocumentNodes> unpack_snapshot(const json &snapshot) {
+    const json &strings = snapshot.contains("strings") ? snapshot["strings"] : kEmptyArray;
+    const json &documents = snapshot["documents"];
+
+    std::vector<DocumentNodes> unpacked;
+    unpacked.reserve(documents.size());
+    for (const auto &document : documents) {
+        unpacked.push_back(unpack_document(document, strings));
+    }
+    // Frame elements point at their content document.
+    for (size_t document_index = 0; document_index < documents.size(); ++document_index) {
+        const json &nodes = documents[document_index].contains("nodes") ? documents[document_index]["nodes"]
+                                                                         : kEmptyObject;
+        if (!nodes.contains("contentDocumentIndex") || !nodes["contentDocumentIndex"].is_object()) {
+            continue;
+        }
+        const json &rare = nodes["contentDocumentIndex"];
+        if (!rare.contains("index") || !rare.contains("value")) {
+            continue;
+        }
+        for (size_t entry = 0; entry < rare["index"].size() && entry < rare["value"].size(); ++entry) {
+            int child = int_at(rare["value"], entry, -1);
+            if (child >= 0 && child < static_cast<int>(unpacked.size()) && child != static_cast<int>(document_index)) {
+                unpacked[child].owner_document = static_cast<int>(document_index);
+                unpacked[child].owner_node = int_at(rare["index"], entry, -1);
+            }
+        }
+    }
+
+    return unpacked;
+}
+
+// Viewport position of each document's origin: the frame element's box in its owner, minus scroll.
+static std::vector<std::pair<double, double>> document_origins(const std::vector<DocumentNodes> &unpacked) {
+    std::vector<std::pair<double, double>> origin(unpacked.size(), {0.0, 0.0});
+    std::vector<int> origin_state(unpacked.size(), 0);  // 0 = todo, 1 = in progress, 2 = done
+    std::function<void(int)> compute_origin = [&](int document_index) {
+        if (origin_state[document_index] != 0) {
+            return;
+        }
+        origin_state[document_index] = 1;
+        const DocumentNodes &document = unpacked[document_index];
+        double x = -document.scroll_x;
+        double y = -document.scroll_y;
+        int owner = document.owner_document;
+        if (owner >= 0 && origin_state[owner] != 1) {
+            compute_origin(owner);
+            x += origin[owner].first;
+            y += origin[owner].second;
+            int node = document.owner_node;
+            if (node >= 0 && node < static_cast<int>(unpacked[owner].layout_index.size()) &&
+                unpacked[owner].layout_index[node] >= 0) {
+                const Box &frame_box = unpacked[owner].boxes[unpacked[owner].layout_index[node]];
+                x += frame_box.x;
+                y += frame_box.y;
+            }
+        }
+        origin[document_index] = {x, y};
+        origin_state[document_index] = 2;
+    };
+
+    for (size_t document_index = 0; document_index < unpacked.size(); ++document_index) {
+        compute_origin(static_cast<int>(document_index));
+    }
+    return origin;
+}
+
+std::vector<SnapshotElement> extract_interactive_elements(const json &snapshot,
+                                                          double viewport_width, double viewport_height) {
+    std::vector<SnapshotElement> elements;
+    if (!snapshot.is_object() || !snapshot.contains("documents") || !snapshot["documents"].is_array()) {
+        return elements;
+    }
+    const json &strings = snapshot.contains("strings") ? snapshot["strings"] : kEmptyArray;
+    const json &documents = snapshot["documents"];
+
+    std::vector<DocumentNodes> unpacked = unpack_snapshot(snapshot);
+    std::vector<std::pair<double, double>> origin = document_origins(unpacked);
+
+    for (size_t document_index = 0; document_index < unpacked.size(); ++document_index) {
+        const DocumentNodes &document = unpacked[document_index];
+        size_t node_count = document.node_type.size();
+
+        // Text is gathered for candidates and labels, like innerText: rendered text nodes only
+        // (option text is kept, closed <select> options have no layout).
+        std::vector<int> text_slot(node_count, -1);
+        std::vector<std::string> texts;
+        for (size_t node = 0; node < node_count; ++node) {
+            if (is_interactive(document, static_cast<int>(node)) || document.node_name[node] == "LABEL") {
+                text_slot[node] = static_cast<int>(texts.size());
+                texts.emplace_back();
+            }
+        }
+        const json &node_values = documents[document_index].contains("nodes") &&
+                                          documents[document_index]["nodes"].contains("nodeValue")
+                                      ? documents[document_index]["nodes"]["nodeValue"]
+                                      : kEmptyArray;
+        for (size_t node = 0; node < node_count; ++node) {
+            if (document.node_type[node] != kNodeTypeText) {
+                continue;
+            }
+            int parent = document.parent[node];
+            bool rendered = document.layout_index[node] >= 0 ||
+                            (parent >= 0 && document.node_name[parent] == "OPTION");
+            if (!rendered || !node_values.is_array() || node >= node_values.size()) {
+                continue;
+            }
+            std::string value = lookup_string(strings, node_values[node]);
+            for (int ancestor = parent; ancestor >= 0; ancestor = document.parent[ancestor]) {
+                if (text_slot[ancestor] >= 0) {
+                    std::string &text = texts[text_slot[ancestor]];
+                    if (!text.empty() && text.back() != ' ') {
+                        text.push_back(' ');
+                    }
+                    append_collapsed(text, value);
+                }
+            }
+        }
+
+        std::map<std::string, std::string> label_by_for;
+        for (size_t node = 0; node < node_count; ++node) {
+            if (document.node_name[node] == "LABEL" && has_attribute(document, static_cast<int>(node), "for")) {
+                label_by_for.emplace(attribute_of(document, static_cast<int>(node), "for"),
+                                     trimmed(texts[text_slot[node]]));
+            }
+        }
+
+        for (size_t node_index = 0; node_index < node_count; ++node_index) {
+            int node = static_cast<int>(node_index);
+            if (!is_interactive(document, node)) {
+                continue;
+            }
+            const std::string &name = document.node_name[node];
+            std::string role_attribute = attribute_of(document, node, "role");
+
+            // Options of a closed <select> have no box: they count as visible when the select is.
+            int box_node = node;
+            if (!has_visible_box(document, node) && (name == "OPTION" || role_attribute == "option")) {
+                box_node = closest_ancestor_named(document, node, "SELECT");
+            }
+            if (box_node < 0 || !has_visible_box(document, box_node)) {
+                continue;
+            }
+
+            SnapshotElement snapshot_element;
+            snapshot_element.backend_node_id = document.backend_node_id[node];
+            browser_driver::InteractiveElement &element = snapshot_element.element;
+            element.role = !role_attribute.empty() ? role_attribute : (name == "A" ? "link" : to_lower(name));
+            element.placeholder = attribute_of(document, node, "placeholder");
+            if (name == "INPUT") {
+                element.type = to_lower(attribute_of(document, node, "type"));
+                if (element.type.empty()) {
+                    element.type = "text";
+                }
+            } else if (name == "BUTTON") {
+                element.type = to_lower(attribute_of(document, node, "type"));
+                if (element.type.empty()) {
+                    element.type = "submit";
+                }
+            } else if (name == "TEXTAREA") {
+                element.type = "textarea";
+            }
+            element.text = trimmed(texts[text_slot[node]]);
+            if (element.text.empty() && name == "INPUT" &&
+                (element.type == "button" || element.type == "submit" || element.type == "reset")) {
+                element.text = attribute_of(document, node, "value");
+            }
+
+            std::string id = attribute_of(document, node, "id");
+            auto label_iterator = id.empty() ? label_by_for.end() : label_by_for.find(id);
+            if (label_iterator != label_by_for.end()) {
+                element.label = label_iterator->second;
+            }
+            if (element.label.empty()) {
+                int wrapping_label = closest_ancestor_named(document, node, "LABEL");
+                if (wrapping_label >= 0 && name != "A" && name != "BUTTON") {
+                    element.label = trimmed(texts[text_slot[wrapping_label]]);
+                }
+            }
+            if (element.label.empty()) {
+                element.label = element.placeholder;
+            }
+            if (element.label.empty()) {
+                element.label = attribute_of(document, node, "aria-label");
+            }
+
+            const Box &box = document.boxes[document.layout_index[box_node]];
+            double left = box.x + origin[document_index].first;
+            double top = box.y + origin[document_index].second;
+            snapshot_element.in_viewport = viewport_width <= 0 || viewport_height <= 0 ||
+                                           (left < viewport_width && left + box.width > 0 &&
+                                            top < viewport_height && top + box.height > 0);
+            elements.push_back(std::move(snapshot_element));
+        }
+    }
+    return elements;
+}
+
+std::unordered_set<int> backend_node_ids_in_viewport(const json &snapshot,
+                                                     double viewport_width, double viewport_height) {
+    std::unordered_set<int> visible;
+    if (!snapshot.is_object() || !snapshot.contains("documents") || !snapshot["documents"].is_array()) {
+        return visible;
+    }
+    std::vector<DocumentNodes> unpacked = unpack_snapshot(snapshot);
+    std::vector<std::pair<double, double>> origin = document_origins(unpacked);
+    for (size_t document_index = 0; document_index < unpacked.size(); ++document_index) {
+        const DocumentNodes &document = unpacked[document_index];
+        for (size_t node = 0; node < document.layout_index.size(); ++node) {
+            int layout_entry = document.layout_index[node];
+            if (layout_entry < 0 || document.hidden_style[layout_entry]) {
+                continue;
+            }
+            const Box &box = document.boxes[layout_entry];
+            double left = box.x + origin[document_index].first;
+            double top = box.y + origin[document_index].second;
+            if (box.width > 0 && box.height > 0 && left < viewport_width && left + box.width > 0 &&
+                top < viewport_height && top + box.height > 0) {
+                visible.insert(document.backend_node_id[node]);
+            }
+        }
+    }
+    return visible;
+}
+
+} // namespace cdp_dom_snapshot
@@ -0,0 +1,40 @@
+#ifndef BMCPS_CDP_DOM_SNAPSHOT_HPP
+#define BMCPS_CDP_DOM_SNAPSHOT_HPP
+
+// Interactive-element extraction from a DOMSnapshot.captureSnapshot response.
+// The whole DOM, layout boxes and computed styles arrive in one transfer; filtering
+// (visibility, viewport) and label/text derivation happen here, without touching the page.
+
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "browser/browser_driver_abi.hpp"
+
+namespace cdp_dom_snapshot {
+
+// Computed styles to request from DOMSnapshot.captureSnapshot, in the order extraction expects.
+std::vector<std::string> required_computed_styles();
+
+// One interactive element found in the snapshot. element.selector is left empty.
+struct SnapshotElement {
+    int backend_node_id = 0;
+    browser_driver::InteractiveElement element;
+    bool in_viewport = false;  // box intersects the viewport (true when the viewport size is unknown)
+};
+
+// Visible form fields and clickable elements (same set as list_interactive_elements:
+// input, textarea, button, a, option, role=button, role=option) of every document in the
+// snapshot, in document order. Iframe documents are offset by their frame element's box.
+// viewport_width/height are CSS pixels; 0 = unknown.
+std::vector<SnapshotElement> extract_interactive_elements(const nlohmann::json &snapshot,
+                                                          double viewport_width, double viewport_height);
+
+// backendNodeIds of rendered nodes (elements and text) whose box intersects the viewport.
+std::unordered_set<int> backend_node_ids_in_viewport(const nlohmann::json &snapshot,
+                                                     double viewport_width, double viewport_height);
+
+} // namespace cdp_dom_snapshot
+
+#endif // BMCPS_CDP_DOM_SNAPSHOT_HPP
@@ -1,5 +1,7 @@
 #include "browser/cdp/cdp_driver.hpp"
 #include "browser/cdp/cdp_chrome_launch.hpp"
+#include "browser/cdp/cdp_ax_outline.hpp"
+#include "browser/cdp/cdp_page_runtime.hpp"
 #include "platform/platform_abi.hpp"
 #include "utils/debug_log.hpp"
 #include "utils/utf8_sanitize.hpp"
@@ -7,14 +9,20 @@
 #include <libwebsockets.h>
 #include <iostream>
 #include <cstring>
+#include <cerrno>
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
 
 namespace cdp_driver {
 
-// Module-level connection state (not a class instance; global singleton).
-static ConnectionState global_state;
+// Pool of browser instances, one ConnectionState (Chrome process + WebSocket) each.
+// Driver functions operate on active_browser; the pool always holds at least one entry after initialize().
+static std::vector<std::unique_ptr<ConnectionState>> browser_pool;
+static ConnectionState *active_browser = nullptr;
 
 // Forward declaration of the WebSocket callback.
 static int websocket_callback(struct lws *websocket_instance, enum lws_callback_reasons reason,
@@ -23,47 +31,329 @@ static int websocket_callback(struct lws *websocket_instance, enum lws_callback_
 // WebSocket protocol definition for libwebsockets. Filled at runtime in initialize() with cdp_rx_buffer_size.
 static struct lws_protocols websocket_protocols[2];
 
+// --- Target table (Target.targetCreated / targetInfoChanged / targetDestroyed) ---
+
+// Insert or update a target from a CDP TargetInfo object.
+static void upsert_target(const json &target_info) {
+    if (!target_info.contains("targetId") || !target_info["targetId"].is_string()) {
+        return;
+    }
+    std::string target_id = target_info["targetId"].get<std::string>();
+    std::lock_guard<std::mutex> lock(active_browser->target_mutex);
+    auto record_iterator = std::find_if(active_browser->targets.begin(), active_browser->targets.end(),
+                                        [&](const TargetRecord &record) { return record.target_id == target_id; });
+    if (record_iterator == active_browser->targets.end()) {
+        TargetRecord record;
+        record.target_id = target_id;
+        active_browser->targets.push_back(record);
+        record_iterator = active_browser->targets.end() - 1;
+    }
+    if (target_info.contains("type") && target_info["type"].is_string()) {
+        record_iterator->type = target_info["type"].get<std::string>();
+    }
+    if (target_info.contains("title") && target_info["title"].is_string()) {
+        record_iterator->title = target_info["title"].get<std::string>();
+    }
+    if (target_info.contains("url") && target_info["url"].is_string()) {
+        record_iterator->url = target_info["url"].get<std::string>();
+    }
+    if (target_info.contains("browserContextId") && target_info["browserContextId"].is_string()) {
+        record_iterator->browser_context_id = target_info["browserContextId"].get<std::string>();
+    }
+}
+
+static void remove_target(const std::string &target_id) {
+    std::lock_guard<std::mutex> lock(active_browser->target_mutex);
+    active_browser->targets.erase(
+        std::remove_if(active_browser->targets.begin(), active_browser->targets.end(),
+                       [&](const TargetRecord &record) { return record.target_id == target_id; }),
+        active_browser->targets.end());
+}
+
+// Copy of all page targets in table order (the tab order used by list_tabs and switch_tab).
+// Drains already-received events first so the table reflects what Chrome has reported.
+static std::vector<TargetRecord> page_targets_snapshot() {
+    service_websocket(0);
+    std::vector<TargetRecord> page_targets;
+    std::lock_guard<std::mutex> lock(active_browser->target_mutex);
+    for (const auto &record : active_browser->targets) {
+        if (record.type == "page") {
+            page_targets.push_back(record);
+        }
+    }
+    return page_targets;
+}
+
+// --- Per-session state buckets ---
+
+// Object group holding the elements behind list_interactive_elements handles.
+static const char kElementHandleObjectGroup[] = "bmcps-element-handles";
+
+static std::shared_ptr<SessionState> find_session_state(const std::string &session_id) {
+    std::lock_guard<std::mutex> lock(active_browser->sessions_mutex);
+    auto session_iterator = active_browser->sessions_by_id.find(session_id);
+    if (session_iterator == active_browser->sessions_by_id.end()) {
+        return nullptr;
+    }
+    return session_iterator->second;
+}
+
+// Get the bucket for session_id, creating it if this is the first time we see the session.
+// Only attaching creates buckets: a bucket dropped on detach must not come back from a late event.
+static std::shared_ptr<SessionState> get_or_create_session_state(const std::string &session_id,
+                                                                 const std::string &target_id = "") {
+    std::lock_guard<std::mutex> lock(active_browser->sessions_mutex);
+    std::shared_ptr<SessionState> &session_state = active_browser->sessions_by_id[session_id];
+    if (!session_state) {
+        session_state = std::make_shared<SessionState>();
+        session_state->session_id = session_id;
+    }
+    if (!target_id.empty()) {
+        session_state->target_id = target_id;
+    }
+    return session_state;
+}
+
+// Session/target that driver commands go to: the routed tab (route_to_tab) if set, else the current tab.
+static const std::string &active_session_id() {
+    return active_browser->routed_session_id.empty() ? active_browser->current_session_id
+                                                  : active_browser->routed_session_id;
+}
+
+static const std::string &active_target_id() {
+    return active_browser->routed_target_id.empty() ? active_browser->current_target_id
+                                                 : active_browser->routed_target_id;
+}
+
+// Bucket of the active tab. Never null: a detached (or no) session gets a throwaway bucket.
+static std::shared_ptr<SessionState> current_session_state() {
+    std::shared_ptr<SessionState> session_state;
+    if (!active_session_id().empty()) {
+        session_state = find_session_state(active_session_id());
+    }
+    return session_state ? session_state : std::make_shared<SessionState>();
+}
+
+// Bucket an event belongs to: its sessionId, or the current tab for browser-level events.
+// Null for sessions without a bucket (events still in flight after a detach).
+static std::shared_ptr<SessionState> event_session_state(const json &message) {
+    if (message.contains("sessionId") && message["sessionId"].is_string()) {
+        return find_session_state(message["sessionId"].get<std::string>());
+    }
+    if (active_browser->current_session_id.empty()) {
+        return nullptr;
+    }
+    return find_session_state(active_browser->current_session_id);
+}
+
+// Session already attached to target_id, or empty if none.
+static std::string find_session_for_target(const std::string &target_id) {
+    std::lock_guard<std::mutex> lock(active_browser->sessions_mutex);
+    for (const auto &entry : active_browser->sessions_by_id) {
+        if (entry.second->target_id == target_id) {
+            return entry.first;
+        }
+    }
+    return "";
+}
+
+static void remove_session_state(const std::string &session_id) {
+    std::lock_guard<std::mutex> lock(active_browser->sessions_mutex);
+    active_browser->sessions_by_id.erase(session_id);
+}
+
+// Session for target_id: reused if the target is already attached (its buckets keep their data),
+// otherwise attached with Target.attachToTarget.
+static bool session_for_target(const std::string &target_id, std::string &out_session_id,
+                               std::string &out_error) {
+    out_session_id = find_session_for_target(target_id);
+    if (!out_session_id.empty()) {
+        return true;
+    }
+    json attach_params;
+    attach_params["targetId"] = target_id;
+    attach_params["flatten"] = true;
+    json attach_response = send_command("Target.attachToTarget", attach_params);
+    if (!attach_response.contains("result") || !attach_response["result"].contains("sessionId")) {
+        out_error = "Target.attachToTarget failed: " + attach_response.dump();
+        return false;
+    }
+    out_session_id = attach_response["result"]["sessionId"].get<std::string>();
+    get_or_create_session_state(out_session_id, target_id);
+    return true;
+}
+
+// Make target_id the current tab.
+static bool attach_to_target(const std::string &target_id, std::string &out_error) {
+    std::string session_id;
+    if (!session_for_target(target_id, session_id, out_error)) {
+        return false;
+    }
+    active_browser->current_target_id = target_id;
+    active_browser->current_session_id = session_id;
+    enable_console_for_session();
+    return true;
+}
+
+// Add contextId for the frame selected with switch_to_frame on the current tab (none = main frame).
+static void apply_frame_context(json &eval_params) {
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+    if (session_state->current_execution_context_id != 0) {
+        eval_params["contextId"] = session_state->current_execution_context_id;
+    }
+}
+
+static void clear_console_entries(SessionState &session_state) {
+    std::lock_guard<std::mutex> lock(session_state.console_mutex);
+    session_state.console_entries.clear();
+}
+
+// New main-frame document or renderer: requests of the old one may never get their
+// loadingFinished/loadingFailed, so in-flight tracking starts over (with a fresh idle window).
+static void reset_inflight_requests(SessionState &session_state) {
+    std::lock_guard<std::mutex> lock(session_state.network_mutex);
+    session_state.inflight_request_ids.clear();
+    session_state.network_last_activity = std::chrono::steady_clock::now();
+}
+
+// New main-frame document: the cached root nodeId and the element snapshot refer to the old one.
+static void clear_dom_cache(SessionState &session_state) {
+    std::lock_guard<std::mutex> lock(session_state.dom_mutex);
+    session_state.document_node_id = 0;
+    session_state.snapshot_elements_valid = false;
+    session_state.snapshot_elements.clear();
+}
+
+// Update per-frame lifecycle from a Page.* event. A new loader id starts a new document:
+// its milestones start empty. frameNavigated counts as "commit"; loadEventFired (main frame only)
+// and frameStoppedLoading after DOMContentLoaded count as "load".
+static void record_lifecycle_event(SessionState &session_state, const std::string &method, const json &params) {
+    std::string frame_id;
+    std::string loader_id;
+    if (method == "Page.frameNavigated") {
+        if (!params.contains("frame") || !params["frame"].is_object()) {
+            return;
+        }
+        frame_id = params["frame"].value("id", "");
+        loader_id = params["frame"].value("loaderId", "");
+    } else if (method == "Page.loadEventFired") {
+        frame_id = session_state.target_id;
+    } else {
+        frame_id = params.value("frameId", "");
+        loader_id = params.value("loaderId", "");
+    }
+    if (frame_id.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(session_state.lifecycle_mutex);
+    FrameLifecycle &lifecycle = session_state.lifecycle_by_frame_id[frame_id];
+    if (!loader_id.empty() && loader_id != lifecycle.loader_id) {
+        lifecycle.loader_id = loader_id;
+        lifecycle.events.clear();
+    }
+    if (method == "Page.lifecycleEvent") {
+        std::string name = params.value("name", "");
+        if (!name.empty() && name != "init") {
+            lifecycle.events.insert(name);
+        }
+    } else if (method == "Page.frameNavigated") {
+        lifecycle.events.insert("commit");
+    } else if (method == "Page.loadEventFired") {
+        lifecycle.events.insert("load");
+    } else if (method == "Page.frameStartedLoading") {
+        lifecycle.loading = true;
+    } else if (method == "Page.frameStoppedLoading") {
+        lifecycle.loading = false;
+        if (lifecycle.events.count("DOMContentLoaded") > 0) {
+            lifecycle.events.insert("load");
+        }
+    }
+}
+
+// Canonical lifecycle milestone name, or empty if unknown. Accepts any letter case.
+static std::string lifecycle_milestone(const std::string &name) {
+    static const char *const kMilestones[] = {"commit", "DOMContentLoaded", "load", "networkIdle",
+                                              "networkAlmostIdle", "firstContentfulPaint", "firstMeaningfulPaint"};
+    std::string lower_name = name;
+    std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(),
+                   [](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+    for (const char *milestone : kMilestones) {
+        std::string lower_milestone = milestone;
+        std::transform(lower_milestone.begin(), lower_milestone.end(), lower_milestone.begin(),
+                       [](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+        if (lower_name == lower_milestone) {
+            return milestone;
+        }
+    }
+    return "";
+}
+
+// Service the connection until the frame's document (loader_id; empty = whatever is current)
+// reached the milestone. Returns false on timeout.
+static bool wait_for_lifecycle_milestone(SessionState &session_state, const std::string &frame_id,
+                                         const std::string &loader_id, const std::string &milestone,
+                                         int timeout_milliseconds) {
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(session_state.lifecycle_mutex);
+            auto lifecycle = session_state.lifecycle_by_frame_id.find(frame_id);
+            if (lifecycle != session_state.lifecycle_by_frame_id.end() &&
+                (loader_id.empty() || lifecycle->second.loader_id == loader_id) &&
+                lifecycle->second.events.count(milestone) > 0) {
+                return true;
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() > timeout_milliseconds ||
+            !active_browser->connected) {
+            return false;
+        }
+        service_websocket(10);
+    }
+}
+
 // --- WebSocket callback ---
 
-static int websocket_callback(struct lws *websocket_instance, enum lws_callback_reasons reason,
-                               void *user_data, void *incoming_data, size_t incoming_length) {
+static int handle_websocket_event(struct lws *websocket_instance, enum lws_callback_reasons reason,
+                                  void *user_data, void *incoming_data, size_t incoming_length) {
     (void)user_data;
 
     switch (reason) {
     case LWS_CALLBACK_CLIENT_ESTABLISHED:
-        global_state.connected = true;
+        active_browser->connected = true;
         debug_log::log("CDP WebSocket connected.");
         break;
 
     case LWS_CALLBACK_CLIENT_RECEIVE: {
         // Accumulate incoming data.
         const char *data_pointer = static_cast<const char *>(incoming_data);
-        global_state.receive_buffer.append(data_pointer, incoming_length);
+        active_browser->receive_buffer.append(data_pointer, incoming_length);
 
         // Check if the full message has been received.
         if (lws_is_final_fragment(websocket_instance)) {
             // Parse the complete JSON message.
             try {
-                json message = json::parse(global_state.receive_buffer);
-                global_state.receive_buffer.clear();
+                json message = json::parse(active_browser->receive_buffer);
+                active_browser->receive_buffer.clear();
 
                 // Check if this is a response (has "id") or an event (no "id").
                 if (message.contains("id") && !message["id"].is_null()) {
                     int message_id = message["id"].get<int>();
-                    std::lock_guard<std::mutex> lock(global_state.pending_mutex);
-                    global_state.pending_responses[message_id] = message;
-                    global_state.pending_condition.notify_all();
+                    std::lock_guard<std::mutex> lock(active_browser->pending_mutex);
+                    if (active_browser->discarded_response_ids.erase(message_id) == 0) {
+                        active_browser->pending_responses[message_id] = message;
+                        active_browser->pending_condition.notify_all();
+                    }
                 } else {
                     // CDP event (method without id).
                     if (message.contains("method")) {
                         std::string method = message["method"].get<std::string>();
                         if (method == "Runtime.consoleAPICalled") {
-                            std::string event_session_id;
-                            if (message.contains("sessionId") && message["sessionId"].is_string()) {
-                                event_session_id = message["sessionId"].get<std::string>();
-                            }
-                            if ((event_session_id.empty() || event_session_id == global_state.current_session_id) &&
-                                message.contains("params")) {
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state && message.contains("params")) {
                                 const json &params = message["params"];
                                 std::string level = "info";
                                 if (params.contains("type") && params["type"].is_string()) {
@@ -100,28 +390,30 @@ static int websocket_callback(struct lws *websocket_instance, enum lws_callback_
                                 entry.level = level;
                                 entry.text = std::move(text_parts);
                                 {
-                                    std::lock_guard<std::mutex> lock(global_state.console_mutex);
-                                    global_state.console_entries.push_back(std::move(entry));
-                                    while (global_state.console_entries.size() > ConnectionState::kConsoleEntriesMax) {
-                                        global_state.console_entries.erase(global_state.console_entries.begin());
+                                    std::lock_guard<std::mutex> lock(session_state->console_mutex);
+                                    session_state->console_entries.push_back(std::move(entry));
+                                    while (session_state->console_entries.size() > SessionState::kConsoleEntriesMax) {
+                                        session_state->console_entries.pop_front();
                                     }
                                 }
                             }
                         } else if (method == "Page.javascriptDialogOpening") {
-                            if (message.contains("params")) {
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state && message.contains("params")) {
                                 const json &params = message["params"];
-                                std::lock_guard<std::mutex> lock(global_state.dialog_mutex);
-                                global_state.last_dialog_message.clear();
-                                global_state.last_dialog_type.clear();
+                                std::lock_guard<std::mutex> lock(session_state->dialog_mutex);
+                                session_state->last_dialog_message.clear();
+                                session_state->last_dialog_type.clear();
                                 if (params.contains("message") && params["message"].is_string()) {
-                                    global_state.last_dialog_message = params["message"].get<std::string>();
+                                    session_state->last_dialog_message = params["message"].get<std::string>();
                                 }
                                 if (params.contains("type") && params["type"].is_string()) {
-                                    global_state.last_dialog_type = params["type"].get<std::string>();
+                                    session_state->last_dialog_type = params["type"].get<std::string>();
                                 }
                             }
                         } else if (method == "Runtime.executionContextCreated") {
-                            if (message.contains("params") &&
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state && message.contains("params") &&
                                 message["params"].contains("context")) {
                                 const json &ctx = message["params"]["context"];
                                 int context_id = 0;
@@ -134,12 +426,43 @@ static int websocket_callback(struct lws *websocket_instance, enum lws_callback_
                                     frame_id = ctx["auxData"]["frameId"].get<std::string>();
                                 }
                                 if (!frame_id.empty() && context_id != 0) {
-                                    std::lock_guard<std::mutex> lock(global_state.frame_mutex);
-                                    global_state.execution_context_id_by_frame_id[frame_id] = context_id;
+                                    std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+                                    session_state->execution_context_id_by_frame_id[frame_id] = context_id;
+                                    // The main frame's id is the page's targetId.
+                                    if (frame_id == session_state->target_id && ctx["auxData"].contains("isDefault") &&
+                                        ctx["auxData"]["isDefault"].is_boolean() && ctx["auxData"]["isDefault"].get<bool>()) {
+                                        session_state->main_world_context_id = context_id;
+                                    }
+                                }
+                            }
+                        } else if (method == "Runtime.executionContextDestroyed" ||
+                                   method == "Runtime.executionContextsCleared") {
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state) {
+                                std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+                                bool cleared = method == "Runtime.executionContextsCleared";
+                                if (!cleared && message.contains("params") &&
+                                    message["params"].contains("executionContextId") &&
+                                    message["params"]["executionContextId"].is_number_integer()) {
+                                    int context_id = message["params"]["executionContextId"].get<int>();
+                                    cleared = context_id == session_state->main_world_context_id;
+                                    session_state->script_ids_by_context.erase(context_id);
+                                }
+                                if (cleared) {
+                                    session_state->main_world_context_id = 0;
                                 }
+                                if (method == "Runtime.executionContextsCleared") {
+                                    session_state->script_ids_by_context.clear();
+                                    std::lock_guard<std::mutex> handle_lock(session_state->handle_mutex);
+                                    session_state->handle_object_id_by_item.clear();
+                                }
+                            }
+                            if (session_state && method == "Runtime.executionContextsCleared") {
+                                reset_inflight_requests(*session_state);
                             }
                         } else if (method == "Network.requestWillBeSent") {
-                            if (message.contains("params")) {
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state && message.contains("params")) {
                                 const json &params = message["params"];
                                 std::string request_id;
                                 std::string url;
@@ -161,14 +484,17 @@ static int websocket_callback(struct lws *websocket_instance, enum lws_callback_
                                 entry.url = url;
                                 entry.method = method_str;
                                 entry.status_code = 0;
-                                std::lock_guard<std::mutex> lock(global_state.network_mutex);
-                                global_state.network_requests.push_back(entry);
-                                while (global_state.network_requests.size() > ConnectionState::kNetworkRequestsMax) {
-                                    global_state.network_requests.erase(global_state.network_requests.begin());
+                                std::lock_guard<std::mutex> lock(session_state->network_mutex);
+                                session_state->inflight_request_ids.insert(request_id);  // redirects keep the id
+                                session_state->network_last_activity = std::chrono::steady_clock::now();
+                                session_state->network_requests.push_back(entry);
+                                while (session_state->network_requests.size() > SessionState::kNetworkRequestsMax) {
+                                    session_state->network_requests.pop_front();
                                 }
                             }
                         } else if (method == "Network.responseReceived") {
-                            if (message.contains("params") &&
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state && message.contains("params") &&
                                 message["params"].contains("requestId") &&
                                 message["params"].contains("response")) {
                                 std::string request_id = message["params"]["requestId"].get<std::string>();
@@ -181,8 +507,8 @@ static int websocket_callback(struct lws *websocket_instance, enum lws_callback_
                                     message["params"]["response"]["statusText"].is_string()) {
                                     status_text = message["params"]["response"]["statusText"].get<std::string>();
                                 }
-                                std::lock_guard<std::mutex> lock(global_state.network_mutex);
-                                for (auto &entry : global_state.network_requests) {
+                                std::lock_guard<std::mutex> lock(session_state->network_mutex);
+                                for (auto &entry : session_state->network_requests) {
                                     if (entry.request_id == request_id) {
                                         entry.status_code = status;
                                         entry.status_text = status_text;
@@ -190,6 +516,82 @@ static int websocket_callback(struct lws *websocket_instance, enum lws_callback_
                                     }
                                 }
                             }
+                        } else if (method == "Network.loadingFinished" || method == "Network.loadingFailed") {
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state && message.contains("params") &&
+                                message["params"].contains("requestId") &&
+                                message["params"]["requestId"].is_string()) {
+                                std::lock_guard<std::mutex> lock(session_state->network_mutex);
+                                session_state->inflight_request_ids.erase(
+                                    message["params"]["requestId"].get<std::string>());
+                                session_state->network_last_activity = std::chrono::steady_clock::now();
+                            }
+                        } else if (method == "Page.screencastFrame") {
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state && message.contains("params") && message["params"].contains("data") &&
+                                message["params"]["data"].is_string()) {
+                                const json &params = message["params"];
+                                double timestamp = 0;
+                                if (params.contains("metadata") && params["metadata"].contains("timestamp") &&
+                                    params["metadata"]["timestamp"].is_number()) {
+                                    timestamp = params["metadata"]["timestamp"].get<double>();
+                                }
+                                {
+                                    // Unacknowledged frames can arrive out of order: keep the newest.
+                                    std::lock_guard<std::mutex> lock(session_state->screencast_mutex);
+                                    if (timestamp >= session_state->screencast_frame_timestamp) {
+                                        session_state->screencast_frame_base64 = params["data"].get<std::string>();
+                                        session_state->screencast_frame_timestamp = timestamp;
+                                    }
+                                    ++session_state->screencast_frame_count;
+                                }
+                                if (params.contains("sessionId") && params["sessionId"].is_number_integer()) {
+                                    active_browser->screencast_acks_pending.push_back(
+                                        {session_state->session_id, params["sessionId"].get<int>()});
+                                }
+                            }
+                        } else if (method == "Target.targetCreated" || method == "Target.targetInfoChanged") {
+                            if (message.contains("params") && message["params"].contains("targetInfo")) {
+                                upsert_target(message["params"]["targetInfo"]);
+                            }
+                        } else if (method == "Target.targetDestroyed") {
+                            if (message.contains("params") && message["params"].contains("targetId") &&
+                                message["params"]["targetId"].is_string()) {
+                                std::string target_id = message["params"]["targetId"].get<std::string>();
+                                remove_target(target_id);
+                                std::string session_id = find_session_for_target(target_id);
+                                if (!session_id.empty()) {
+                                    remove_session_state(session_id);
+                                }
+                            }
+                        } else if (method == "Target.detachedFromTarget") {
+                            if (message.contains("params") && message["params"].contains("sessionId") &&
+                                message["params"]["sessionId"].is_string()) {
+                                remove_session_state(message["params"]["sessionId"].get<std::string>());
+                            }
+                        } else if (method == "Page.lifecycleEvent" || method == "Page.frameNavigated" ||
+                                   method == "Page.loadEventFired" ||
+                                   method == "Page.frameStartedLoading" || method == "Page.frameStoppedLoading") {
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state && message.contains("params")) {
+                                record_lifecycle_event(*session_state, method, message["params"]);
+                            }
+                            if (method == "Page.frameNavigated" && session_state && message.contains("params") &&
+                                message["params"].contains("frame") &&
+                                !message["params"]["frame"].contains("parentId")) {
+                                clear_dom_cache(*session_state);
+                                reset_inflight_requests(*session_state);
+                            }
+                        } else if (method == "DOM.documentUpdated") {
+                            std::shared_ptr<SessionState> session_state = event_session_state(message);
+                            if (session_state) {
+                                clear_dom_cache(*session_state);
+                            }
+                        } else if (method == "DOM.childNodeInserted" || method == "DOM.childNodeRemoved" ||
+                                   method == "DOM.attributeModified" || method == "DOM.attributeRemoved" ||
+                                   method == "DOM.childNodeCountUpdated") {
+                            // Sent while DOM is enabled; nothing cached depends on them (the root nodeId
+                            // survives mutations).
                         } else {
                             std::cerr << "[bmcps] CDP event: " << method << std::endl;
                         }
@@ -197,8 +599,8 @@ static int websocket_callback(struct lws *websocket_instance, enum lws_callback_
                 }
             } catch (const json::parse_error &parse_error) {
                 std::cerr << "[bmcps] Failed to parse CDP message: " << parse_error.what()
-                          << ", buffer content: " << global_state.receive_buffer.substr(0, 200) << std::endl;
-                global_state.receive_buffer.clear();
+                          << ", buffer content: " << active_browser->receive_buffer.substr(0, 200) << std::endl;
+                active_browser->receive_buffer.clear();
             }
         }
         break;
@@ -208,14 +610,14 @@ static int websocket_callback(struct lws *websocket_instance, enum lws_callback_
         const char *error_message = incoming_data ? static_cast<const char *>(incoming_data) : "unknown";
         std::cerr << "[bmcps] CDP WebSocket connection error: " << error_message << std::endl;
         debug_log::log("CDP WebSocket connection error (LWS): " + std::string(error_message));
-        global_state.connected = false;
-        global_state.connection_failed = true;
+        active_browser->connected = false;
+        active_browser->connection_failed = true;
         break;
     }
 
     case LWS_CALLBACK_CLIENT_CLOSED:
         std::cerr << "[bmcps] CDP WebSocket closed." << std::endl;
-        global_state.connected = false;
+        active_browser->connected = false;
         break;
 
     case LWS_CALLBACK_CLIENT_WRITEABLE: {
@@ -230,36 +632,67 @@ static int websocket_callback(struct lws *websocket_instance, enum lws_callback_
     return 0;
 }
 
+// Events are handled against the browser that owns the WebSocket (context user pointer),
+// so servicing a background browser never touches the active one's state.
+static int websocket_callback(struct lws *websocket_instance, enum lws_callback_reasons reason,
+                               void *user_data, void *incoming_data, size_t incoming_length) {
+    ConnectionState *owner = nullptr;
+    struct lws_context *context = lws_get_context(websocket_instance);
+    if (context != nullptr) {
+        owner = static_cast<ConnectionState *>(lws_context_user(context));
+    }
+    if (owner == nullptr || owner == active_browser) {
+        return handle_websocket_event(websocket_instance, reason, user_data, incoming_data, incoming_length);
+    }
+    ConnectionState *previous_browser = active_browser;
+    active_browser = owner;
+    int callback_result = handle_websocket_event(websocket_instance, reason, user_data, incoming_data,
+                                                 incoming_length);
+    active_browser = previous_browser;
+    return callback_result;
+}
+
+// Tabs of every connected browser in the pool, in pool order then tab order.
+// This is the combined tab list used by list_tabs, switch_tab and tab_id routing.
+struct PoolTab {
+    ConnectionState *browser = nullptr;
+    int browser_index = 0;
+    TargetRecord record;
+};
+
+static std::vector<PoolTab> pool_page_targets() {
+    std::vector<PoolTab> pool_tabs;
+    ConnectionState *previous_browser = active_browser;
+    for (size_t browser_index = 0; browser_index < browser_pool.size(); browser_index++) {
+        active_browser = browser_pool[browser_index].get();
+        if (!active_browser->connected) {
+            continue;
+        }
+        for (const auto &record : page_targets_snapshot()) {
+            PoolTab pool_tab;
+            pool_tab.browser = active_browser;
+            pool_tab.browser_index = static_cast<int>(browser_index);
+            pool_tab.record = record;
+            pool_tabs.push_back(pool_tab);
+        }
+    }
+    active_browser = previous_browser;
+    return pool_tabs;
+}
+
 // --- Public functions ---
 
 static constexpr size_t kCdpRxBufferMinBytes = 1 * 1024 * 1024;   // 1 MB
 static constexpr size_t kCdpRxBufferMaxBytes = 20 * 1024 * 1024;   // 20 MB
 static constexpr size_t kCdpRxBufferDefaultBytes = 5 * 1024 * 1024; // 5 MB
+static constexpr size_t kBrowserPoolMax = 8;                        // Chrome instances per bmcps process
 
 void initialize() {
-    global_state.cdp_rx_buffer_size = kCdpRxBufferDefaultBytes;
-
-    // Reset scalar fields individually; mutex and condition_variable are not assignable.
-    global_state.connected = false;
-    global_state.shutting_down = false;
-    global_state.websocket_context = nullptr;
-    global_state.websocket_connection = nullptr;
-    global_state.chrome_process_id = -1;
-    global_state.user_data_directory.clear();
-    global_state.next_message_id = 1;
-    global_state.current_target_id.clear();
-    global_state.current_session_id.clear();
-    global_state.last_dialog_message.clear();
-    global_state.last_dialog_type.clear();
-    global_state.execution_context_id_by_frame_id.clear();
-    global_state.current_execution_context_id = 0;
-    global_state.network_requests.clear();
-    global_state.network_enabled = false;
-    {
-        std::lock_guard<std::mutex> lock(global_state.pending_mutex);
-        global_state.pending_responses.clear();
-    }
-    global_state.receive_buffer.clear();
+    // Fresh pool with one (not yet connected) browser; mutex and condition_variable are not assignable.
+    browser_pool.clear();
+    browser_pool.push_back(std::make_unique<ConnectionState>());
+    active_browser = browser_pool.front().get();
+    active_browser->cdp_rx_buffer_size = kCdpRxBufferDefaultBytes;
 }
 
 void set_cdp_rx_buffer_size_mb(int size_mb) {
@@ -269,11 +702,13 @@ void set_cdp_rx_buffer_size_mb(int size_mb) {
     if (size_mb > 20) {
         size_mb = 20;
     }
-    global_state.cdp_rx_buffer_size = static_cast<size_t>(size_mb) * 1024 * 1024;
+    for (auto &browser : browser_pool) {
+        browser->cdp_rx_buffer_size = static_cast<size_t>(size_mb) * 1024 * 1024;
+    }
 }
 
 size_t get_cdp_rx_buffer_size() {
-    return global_state.cdp_rx_buffer_size;
+    return active_browser->cdp_rx_buffer_size;
 }
 
 bool connect(const std::string &websocket_url) {
@@ -314,7 +749,7 @@ bool connect(const std::string &websocket_url) {
     websocket_protocols[0].name = "cdp-protocol";
     websocket_protocols[0].callback = websocket_callback;
     websocket_protocols[0].per_session_data_size = 0;
-    websocket_protocols[0].rx_buffer_size = static_cast<unsigned int>(global_state.cdp_rx_buffer_size);
+    websocket_protocols[0].rx_buffer_size = static_cast<unsigned int>(active_browser->cdp_rx_buffer_size);
     websocket_protocols[1].name = nullptr;
     websocket_protocols[1].callback = nullptr;
     websocket_protocols[1].per_session_data_size = 0;
@@ -326,9 +761,10 @@ bool connect(const std::string &websocket_url) {
     context_info.protocols = websocket_protocols;
     context_info.gid = -1;
     context_info.uid = -1;
+    context_info.user = active_browser;  // websocket_callback routes events to this browser
 
-    global_state.websocket_context = lws_create_context(&context_info);
-    if (global_state.websocket_context == nullptr) {
+    active_browser->websocket_context = lws_create_context(&context_info);
+    if (active_browser->websocket_context == nullptr) {
         std::cerr << "[bmcps] Failed to create libwebsockets context." << std::endl;
         return false;
     }
@@ -336,7 +772,7 @@ bool connect(const std::string &websocket_url) {
     // Connect to the CDP WebSocket.
     struct lws_client_connect_info connect_info;
     memset(&connect_info, 0, sizeof(connect_info));
-    connect_info.context = global_state.websocket_context;
+    connect_info.context = active_browser->websocket_context;
     connect_info.address = host.c_str();
     connect_info.port = port;
     connect_info.path = path.c_str();
@@ -345,27 +781,27 @@ bool connect(const std::string &websocket_url) {
     connect_info.protocol = nullptr;
 
     debug_log::log("connect() host=" + host + " port=" + std::to_string(port) + " path=" + path + " (no subprotocol)");
-    global_state.connection_failed = false;
-    global_state.websocket_connection = lws_client_connect_via_info(&connect_info);
-    if (global_state.websocket_connection == nullptr) {
+    active_browser->connection_failed = false;
+    active_browser->websocket_connection = lws_client_connect_via_info(&connect_info);
+    if (active_browser->websocket_connection == nullptr) {
         std::cerr << "[bmcps] Failed to initiate CDP WebSocket connection (lws_client_connect_via_info returned null)." << std::endl;
         debug_log::log("connect(): lws_client_connect_via_info returned null.");
-        lws_context_destroy(global_state.websocket_context);
-        global_state.websocket_context = nullptr;
+        lws_context_destroy(active_browser->websocket_context);
+        active_browser->websocket_context = nullptr;
         return false;
     }
 
     auto start_time = std::chrono::steady_clock::now();
     int connection_timeout_milliseconds = 20000;
 
-    while (!global_state.connected) {
-        lws_service(global_state.websocket_context, 50);
+    while (!active_browser->connected) {
+        lws_service(active_browser->websocket_context, 50);
 
-        if (global_state.connection_failed) {
+        if (active_browser->connection_failed) {
             std::cerr << "[bmcps] CDP WebSocket connection failed (see error above)." << std::endl;
             debug_log::log("connect(): connection_failed was set by LWS callback.");
-            lws_context_destroy(global_state.websocket_context);
-            global_state.websocket_context = nullptr;
+            lws_context_destroy(active_browser->websocket_context);
+            active_browser->websocket_context = nullptr;
             return false;
         }
 
@@ -373,8 +809,8 @@ bool connect(const std::string &websocket_url) {
         if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() > connection_timeout_milliseconds) {
             std::cerr << "[bmcps] Timed out connecting to CDP WebSocket (after " << (connection_timeout_milliseconds / 1000) << " s)." << std::endl;
             debug_log::log("connect(): timed out after " + std::to_string(connection_timeout_milliseconds) + " ms.");
-            lws_context_destroy(global_state.websocket_context);
-            global_state.websocket_context = nullptr;
+            lws_context_destroy(active_browser->websocket_context);
+            active_browser->websocket_context = nullptr;
             return false;
         }
     }
@@ -382,41 +818,122 @@ bool connect(const std::string &websocket_url) {
     return true;
 }
 
-void disconnect() {
+// Close the active browser's WebSocket and kill its Chrome (if we launched it); the entry stays in the pool.
+static void disconnect_active_browser() {
     debug_log::log("disconnect() called. shutting_down=true, will destroy WebSocket and kill Chrome if we launched it.");
-    global_state.shutting_down = true;
+    active_browser->shutting_down = true;
 
-    if (global_state.websocket_context != nullptr) {
-        lws_context_destroy(global_state.websocket_context);
-        global_state.websocket_context = nullptr;
+    if (active_browser->websocket_context != nullptr) {
+        lws_context_destroy(active_browser->websocket_context);
+        active_browser->websocket_context = nullptr;
         debug_log::log("disconnect(): WebSocket context destroyed.");
     }
 
-    if (global_state.chrome_process_id > 0) {
-        debug_log::log("disconnect(): Killing Chrome process id=" + std::to_string(global_state.chrome_process_id));
-        platform::kill_process(global_state.chrome_process_id);
+    if (active_browser->chrome_process_id > 0) {
+        debug_log::log("disconnect(): Killing Chrome process id=" + std::to_string(active_browser->chrome_process_id));
+        platform::kill_process(active_browser->chrome_process_id);
+    }
+    active_browser->chrome_process_id = -1;
+    active_browser->connected = false;
+    {
+        std::lock_guard<std::mutex> lock(active_browser->target_mutex);
+        active_browser->targets.clear();
     }
-    global_state.chrome_process_id = -1;
-    global_state.connected = false;
+    {
+        std::lock_guard<std::mutex> lock(active_browser->sessions_mutex);
+        active_browser->sessions_by_id.clear();
+    }
+    active_browser->current_target_id.clear();
+    active_browser->current_session_id.clear();
+    active_browser->routed_target_id.clear();
+    active_browser->routed_session_id.clear();
     debug_log::log("disconnect() finished.");
 }
 
+void disconnect() {
+    for (auto &browser : browser_pool) {
+        active_browser = browser.get();
+        disconnect_active_browser();
+    }
+    size_t rx_buffer_size = browser_pool.empty() ? kCdpRxBufferDefaultBytes : browser_pool.front()->cdp_rx_buffer_size;
+    initialize();
+    active_browser->cdp_rx_buffer_size = rx_buffer_size;
+}
+
+void disconnect_current_browser() {
+    if (browser_pool.size() <= 1) {
+        disconnect();
+        return;
+    }
+    disconnect_active_browser();
+    browser_pool.erase(std::remove_if(browser_pool.begin(), browser_pool.end(),
+                                      [](const std::unique_ptr<ConnectionState> &browser) {
+                                          return browser.get() == active_browser;
+                                      }),
+                       browser_pool.end());
+    active_browser = browser_pool.front().get();
+    for (auto &browser : browser_pool) {
+        if (browser->connected) {
+            active_browser = browser.get();
+            break;
+        }
+    }
+}
+
+int browser_pool_size() {
+    int connected_count = 0;
+    for (const auto &browser : browser_pool) {
+        if (browser->connected) {
+            connected_count++;
+        }
+    }
+    return connected_count;
+}
+
+// Acknowledge received screencast frames so Chrome sends the next one; responses are discarded.
+// Every pool browser is flushed: background browsers are serviced too and queue acks of their own.
+static void flush_screencast_acks() {
+    ConnectionState *previous_browser = active_browser;
+    for (auto &browser : browser_pool) {
+        if (browser->screencast_acks_pending.empty() || !browser->connected) {
+            continue;
+        }
+        active_browser = browser.get();
+        std::vector<std::pair<std::string, int>> acks;
+        acks.swap(active_browser->screencast_acks_pending);
+        for (const auto &ack : acks) {
+            json ack_params;
+            ack_params["sessionId"] = ack.second;
+            int message_id = send_command_async("Page.screencastFrameAck", ack_params, ack.first);
+            if (message_id >= 0) {
+                std::lock_guard<std::mutex> lock(active_browser->pending_mutex);
+                active_browser->discarded_response_ids.insert(message_id);
+            }
+        }
+    }
+    active_browser = previous_browser;
+}
+
 void service_websocket(int timeout_milliseconds) {
-    if (global_state.websocket_context != nullptr) {
-        lws_service(global_state.websocket_context, timeout_milliseconds);
+    if (active_browser->websocket_context != nullptr) {
+        lws_service(active_browser->websocket_context, timeout_milliseconds);
     }
+    // Keep background browsers' buffers and target tables current without blocking on them.
+    for (auto &browser : browser_pool) {
+        if (browser.get() != active_browser && browser->websocket_context != nullptr) {
+            lws_service(browser->websocket_context, 0);
+        }
+    }
+    flush_screencast_acks();
 }
 
-json send_command(const std::string &method, const json &params,
-                  const std::string &session_id, int timeout_milliseconds) {
-    if (!global_state.connected || global_state.websocket_connection == nullptr) {
-        json error_response;
-        error_response["error"] = "Not connected to CDP";
-        return error_response;
+int send_command_async(const std::string &method, const json &params, const std::string &session_id) {
+    if (!active_browser->connected || active_browser->websocket_connection == nullptr) {
+        return -1;
     }
 
     // Build the CDP command message.
-    int message_id = global_state.next_message_id++;
+    int message_id = active_browser->next_message_id++;
     json command;
     command["id"] = message_id;
     command["method"] = method;
@@ -434,10 +951,17 @@ json send_command(const std::string &method, const json &params,
     std::vector<unsigned char> send_buffer(LWS_PRE + serialized_command.size());
     memcpy(send_buffer.data() + LWS_PRE, serialized_command.c_str(), serialized_command.size());
 
-    int bytes_written = lws_write(global_state.websocket_connection,
+    int bytes_written = lws_write(active_browser->websocket_connection,
                                    send_buffer.data() + LWS_PRE,
                                    serialized_command.size(), LWS_WRITE_TEXT);
     if (bytes_written < 0) {
+        return -1;
+    }
+    return message_id;
+}
+
+json wait_for_response(int message_id, const std::string &method, int timeout_milliseconds) {
+    if (message_id < 0) {
         json error_response;
         error_response["error"] = "Failed to send CDP command via WebSocket";
         return error_response;
@@ -449,15 +973,12 @@ json send_command(const std::string &method, const json &params,
     int maximum_iterations = (timeout_milliseconds / 10) * 2 + 100;
 
     for (int iteration = 0; iteration < maximum_iterations; iteration++) {
-        // Service the event loop to receive messages.
-        lws_service(global_state.websocket_context, 10);
-
         {
-            std::lock_guard<std::mutex> lock(global_state.pending_mutex);
-            auto response_iterator = global_state.pending_responses.find(message_id);
-            if (response_iterator != global_state.pending_responses.end()) {
+            std::lock_guard<std::mutex> lock(active_browser->pending_mutex);
+            auto response_iterator = active_browser->pending_responses.find(message_id);
+            if (response_iterator != active_browser->pending_responses.end()) {
                 json response = response_iterator->second;
-                global_state.pending_responses.erase(response_iterator);
+                active_browser->pending_responses.erase(response_iterator);
                 return response;
             }
         }
@@ -469,6 +990,10 @@ json send_command(const std::string &method, const json &params,
             error_response["message_id"] = message_id;
             return error_response;
         }
+
+        // Service the event loop to receive messages. Background pool browsers are serviced too,
+        // so a long command here does not leave their events, frames and acks waiting.
+        service_websocket(10);
     }
 
     json error_response;
@@ -476,20 +1001,46 @@ json send_command(const std::string &method, const json &params,
     return error_response;
 }
 
+json send_command(const std::string &method, const json &params,
+                  const std::string &session_id, int timeout_milliseconds) {
+    if (!active_browser->connected || active_browser->websocket_connection == nullptr) {
+        json error_response;
+        error_response["error"] = "Not connected to CDP";
+        return error_response;
+    }
+    return wait_for_response(send_command_async(method, params, session_id), method, timeout_milliseconds);
+}
+
 // --- High-level browser operations ---
 
 browser_driver::DriverResult open_browser(const browser_driver::OpenBrowserOptions &options) {
     browser_driver::DriverResult result;
     bool connected = false;
 
-    if (!options.disable_translate) {
+    browser_driver::OpenBrowserOptions launch_options = options;
+    if (options.new_instance && active_browser->connected) {
+        if (browser_pool.size() >= kBrowserPoolMax) {
+            result.success = false;
+            result.error_detail = "Browser pool is full (" + std::to_string(kBrowserPoolMax) + " instances). Close one with close_browser first.";
+            result.message = "Failed to open browser.";
+            return result;
+        }
+        auto instance = std::make_unique<ConnectionState>();
+        instance->cdp_rx_buffer_size = active_browser->cdp_rx_buffer_size;
+        launch_options.pool_index = static_cast<int>(browser_pool.size());
+        active_browser = instance.get();
+        browser_pool.push_back(std::move(instance));
+        debug_log::log("open_browser: adding browser instance " + std::to_string(launch_options.pool_index) + " to the pool");
+    }
+
+    if (!options.disable_translate && launch_options.pool_index == 0) {
         std::string existing_url = cdp_chrome_launch::try_get_existing_websocket_url(cdp_chrome_launch::BMCPS_FIXED_USER_DATA_DIR);
         if (!existing_url.empty()) {
             debug_log::log("open_browser: Found existing Chrome, trying to connect to " + existing_url);
             connected = connect(existing_url);
             if (connected) {
-                global_state.chrome_process_id = -1;
-                global_state.user_data_directory = cdp_chrome_launch::BMCPS_FIXED_USER_DATA_DIR;
+                active_browser->chrome_process_id = -1;
+                active_browser->user_data_directory = cdp_chrome_launch::BMCPS_FIXED_USER_DATA_DIR;
             } else {
                 debug_log::log("open_browser: Connect to existing Chrome failed, will launch new one.");
             }
@@ -499,25 +1050,31 @@ browser_driver::DriverResult open_browser(const browser_driver::OpenBrowserOptio
     }
 
     if (!connected) {
-        cdp_chrome_launch::ChromeLaunchResult launch_result = cdp_chrome_launch::launch_chrome(options);
+        cdp_chrome_launch::ChromeLaunchResult launch_result = cdp_chrome_launch::launch_chrome(launch_options);
         if (!launch_result.success) {
             result.success = false;
             result.error_detail = launch_result.error_message;
             result.message = "Failed to launch Chrome.";
+            if (launch_options.pool_index > 0) {
+                disconnect_current_browser();
+            }
             return result;
         }
-        global_state.chrome_process_id = launch_result.process_id;
-        global_state.user_data_directory = launch_result.user_data_directory;
+        active_browser->chrome_process_id = launch_result.process_id;
+        active_browser->user_data_directory = launch_result.user_data_directory;
 
         debug_log::log("Connecting to CDP WebSocket…");
         connected = connect(launch_result.websocket_debugger_url);
         if (!connected) {
-            debug_log::log("open_browser: WebSocket connect failed, killing Chrome pid=" + std::to_string(global_state.chrome_process_id));
+            debug_log::log("open_browser: WebSocket connect failed, killing Chrome pid=" + std::to_string(active_browser->chrome_process_id));
             result.success = false;
             result.error_detail = "Could not establish WebSocket connection to: " + launch_result.websocket_debugger_url;
             result.message = "Failed to connect to Chrome CDP.";
-            platform::kill_process(global_state.chrome_process_id);
-            global_state.chrome_process_id = -1;
+            platform::kill_process(active_browser->chrome_process_id);
+            active_browser->chrome_process_id = -1;
+            if (launch_options.pool_index > 0) {
+                disconnect_current_browser();
+            }
             return result;
         }
     }
@@ -534,24 +1091,35 @@ browser_driver::DriverResult open_browser(const browser_driver::OpenBrowserOptio
                   << discover_response.dump() << std::endl;
     }
 
+    // Seed the target table once; from here on Target.* discovery events keep it current.
+    // Targets already reported by discovery events are moved into Target.getTargets order, so tab
+    // indexes start out as Chrome lists them; tabs opened later are appended.
     json get_targets_response = send_command("Target.getTargets", json::object());
-    int target_count = 0;
     if (get_targets_response.contains("result") && get_targets_response["result"].contains("targetInfos")) {
-        target_count = static_cast<int>(get_targets_response["result"]["targetInfos"].size());
+        std::vector<std::string> listed_target_ids;
+        for (const auto &target_info : get_targets_response["result"]["targetInfos"]) {
+            upsert_target(target_info);
+            if (target_info.contains("targetId") && target_info["targetId"].is_string()) {
+                listed_target_ids.push_back(target_info["targetId"].get<std::string>());
+            }
+        }
+        auto listed_position = [&](const TargetRecord &record) {
+            return std::find(listed_target_ids.begin(), listed_target_ids.end(), record.target_id) -
+                   listed_target_ids.begin();
+        };
+        std::lock_guard<std::mutex> lock(active_browser->target_mutex);
+        std::stable_sort(active_browser->targets.begin(), active_browser->targets.end(),
+                         [&](const TargetRecord &left, const TargetRecord &right) {
+                             return listed_position(left) < listed_position(right);
+                         });
     }
-    debug_log::log("open_browser: Target.getTargets returned, target count=" + std::to_string(target_count));
 
-    std::string chosen_target_id;
+    std::vector<TargetRecord> page_targets = page_targets_snapshot();
+    debug_log::log("open_browser: target table seeded, page target count=" + std::to_string(page_targets.size()));
 
-    if (get_targets_response.contains("result") &&
-        get_targets_response["result"].contains("targetInfos")) {
-        const auto &target_infos = get_targets_response["result"]["targetInfos"];
-        for (const auto &target_info : target_infos) {
-            if (target_info.contains("type") && target_info["type"] == "page") {
-                chosen_target_id = target_info["targetId"].get<std::string>();
-                break;
-            }
-        }
+    std::string chosen_target_id;
+    if (!page_targets.empty()) {
+        chosen_target_id = page_targets.front().target_id;
     }
 
     if (chosen_target_id.empty()) {
@@ -580,92 +1148,78 @@ browser_driver::DriverResult open_browser(const browser_driver::OpenBrowserOptio
     }
 
     debug_log::log("open_browser: Attaching to target (Target.attachToTarget) targetId=" + chosen_target_id);
-    // Attach to the chosen target to get a session ID.
-    json attach_params;
-    attach_params["targetId"] = chosen_target_id;
-    attach_params["flatten"] = true;
-    json attach_response = send_command("Target.attachToTarget", attach_params);
-
-    if (attach_response.contains("result") &&
-        attach_response["result"].contains("sessionId")) {
-        global_state.current_target_id = chosen_target_id;
-        global_state.current_session_id = attach_response["result"]["sessionId"].get<std::string>();
-        debug_log::log("open_browser: Target.attachToTarget ok, sessionId=" + global_state.current_session_id);
+    std::string attach_error;
+    if (attach_to_target(chosen_target_id, attach_error)) {
+        debug_log::log("open_browser: Target.attachToTarget ok, sessionId=" + active_browser->current_session_id);
     } else {
-        debug_log::log("open_browser: Target.attachToTarget failed: " + attach_response.dump());
+        debug_log::log("open_browser: " + attach_error);
         result.success = false;
-        result.error_detail = "Target.attachToTarget failed: " + attach_response.dump();
+        result.error_detail = attach_error;
         result.message = "Failed to attach to the browser tab.";
         return result;
     }
 
-    enable_console_for_session();
     result.success = true;
     result.message = "Browser opened and connected to default tab.";
-    debug_log::log("Attached to target id=" + global_state.current_target_id + " session=" + global_state.current_session_id);
+    if (browser_pool.size() > 1) {
+        result.message += " Browser pool: " + std::to_string(browser_pool_size()) + " instance(s).";
+    }
+    debug_log::log("Attached to target id=" + active_browser->current_target_id + " session=" + active_browser->current_session_id);
     return result;
 }
 
 browser_driver::TabListResult list_tabs() {
     browser_driver::TabListResult result;
 
-    if (!global_state.connected) {
+    if (!active_browser->connected) {
         result.success = false;
         result.error_detail = "Not connected to a browser. Call open_browser first.";
         return result;
     }
 
-    json get_targets_response = send_command("Target.getTargets", json::object());
-
-    if (!get_targets_response.contains("result") ||
-        !get_targets_response["result"].contains("targetInfos")) {
-        result.success = false;
-        result.error_detail = "Target.getTargets returned unexpected response: " + get_targets_response.dump();
-        return result;
-    }
-
-    const auto &target_infos = get_targets_response["result"]["targetInfos"];
-    std::vector<browser_driver::TabInfo> page_tabs;
-    for (const auto &target_info : target_infos) {
-        std::string type_str = target_info.contains("type") ? target_info["type"].get<std::string>() : "";
-        if (type_str != "page") {
-            continue;
-        }
+    for (const auto &pool_tab : pool_page_targets()) {
         browser_driver::TabInfo tab;
-        if (target_info.contains("targetId")) {
-            tab.target_id = target_info["targetId"].get<std::string>();
-        }
-        if (target_info.contains("title")) {
-            tab.title = target_info["title"].get<std::string>();
-        }
-        if (target_info.contains("url")) {
-            tab.url = target_info["url"].get<std::string>();
-        }
-        tab.type = type_str;
-        tab.is_current = (tab.target_id == global_state.current_target_id);
-        page_tabs.push_back(tab);
+        tab.target_id = pool_tab.record.target_id;
+        tab.title = pool_tab.record.title;
+        tab.url = pool_tab.record.url;
+        tab.type = pool_tab.record.type;
+        tab.browser_context_id = pool_tab.record.browser_context_id;
+        tab.browser_index = pool_tab.browser_index;
+        tab.is_current = (pool_tab.browser == active_browser &&
+                          tab.target_id == active_browser->current_target_id);
+        result.tabs.push_back(tab);
     }
-    result.tabs = page_tabs;
 
     result.success = true;
     return result;
 }
 
-browser_driver::NavigateResult navigate(const std::string &url) {
+browser_driver::NavigateResult navigate(const std::string &url, const std::string &wait_until,
+                                        int timeout_milliseconds) {
     browser_driver::NavigateResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_text = "No active browser session. Call open_browser first.";
         return result;
     }
+    std::string milestone;
+    if (!wait_until.empty()) {
+        milestone = lifecycle_milestone(wait_until);
+        if (milestone.empty()) {
+            result.success = false;
+            result.error_text = "wait_until must be commit, DOMContentLoaded, load, networkIdle or firstMeaningfulPaint.";
+            return result;
+        }
+    }
+    auto start = std::chrono::steady_clock::now();
 
     json navigate_params;
     navigate_params["url"] = url;
 
     // Send Page.navigate on the current session.
     json navigate_response = send_command("Page.navigate", navigate_params,
-                                           global_state.current_session_id);
+                                           active_session_id());
 
     if (navigate_response.contains("error") && navigate_response["error"].is_string()) {
         result.success = false;
@@ -673,6 +1227,7 @@ browser_driver::NavigateResult navigate(const std::string &url) {
         return result;
     }
 
+    std::string loader_id;
     if (navigate_response.contains("result")) {
         const auto &nav_result = navigate_response["result"];
         if (nav_result.contains("frameId")) {
@@ -683,20 +1238,33 @@ browser_driver::NavigateResult navigate(const std::string &url) {
             result.success = false;
             return result;
         }
+        loader_id = nav_result.value("loaderId", "");
     }
 
-    result.success = true;
-    if (result.success) {
-        std::lock_guard<std::mutex> lock(global_state.console_mutex);
-        global_state.console_entries.clear();
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    clear_console_entries(*session_state);
+
+    // No loaderId = same-document navigation (fragment): there is no new document to wait for.
+    if (!milestone.empty() && !loader_id.empty()) {
+        int remaining = timeout_milliseconds - static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        if (!wait_for_lifecycle_milestone(*session_state, result.frame_id, loader_id, milestone, remaining)) {
+            result.success = false;
+            result.error_text = "Navigation started but timed out waiting for " + milestone + ".";
+            return result;
+        }
     }
+    result.reached = milestone;
+    result.elapsed_milliseconds = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    result.success = true;
     return result;
 }
 
 browser_driver::DriverResult navigate_back() {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "Failed to navigate back.";
@@ -704,7 +1272,7 @@ browser_driver::DriverResult navigate_back() {
     }
 
     json history_response = send_command("Page.getNavigationHistory", json::object(),
-                                         global_state.current_session_id);
+                                         active_session_id());
     if (history_response.contains("error") && history_response["error"].is_string()) {
         result.success = false;
         result.error_detail = history_response["error"].get<std::string>();
@@ -732,7 +1300,7 @@ browser_driver::DriverResult navigate_back() {
     json nav_params;
     nav_params["entryId"] = entry_id;
     json nav_response = send_command("Page.navigateToHistoryEntry", nav_params,
-                                     global_state.current_session_id);
+                                     active_session_id());
     if (nav_response.contains("error") && nav_response["error"].is_string()) {
         result.success = false;
         result.error_detail = nav_response["error"].get<std::string>();
@@ -742,17 +1310,14 @@ browser_driver::DriverResult navigate_back() {
 
     result.success = true;
     result.message = "Navigated back.";
-    {
-        std::lock_guard<std::mutex> lock(global_state.console_mutex);
-        global_state.console_entries.clear();
-    }
+    clear_console_entries(*current_session_state());
     return result;
 }
 
 browser_driver::DriverResult navigate_forward() {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "Failed to navigate forward.";
@@ -760,7 +1325,7 @@ browser_driver::DriverResult navigate_forward() {
     }
 
     json history_response = send_command("Page.getNavigationHistory", json::object(),
-                                         global_state.current_session_id);
+                                         active_session_id());
     if (history_response.contains("error") && history_response["error"].is_string()) {
         result.success = false;
         result.error_detail = history_response["error"].get<std::string>();
@@ -789,7 +1354,7 @@ browser_driver::DriverResult navigate_forward() {
     json nav_params;
     nav_params["entryId"] = entry_id;
     json nav_response = send_command("Page.navigateToHistoryEntry", nav_params,
-                                     global_state.current_session_id);
+                                     active_session_id());
     if (nav_response.contains("error") && nav_response["error"].is_string()) {
         result.success = false;
         result.error_detail = nav_response["error"].get<std::string>();
@@ -799,17 +1364,14 @@ browser_driver::DriverResult navigate_forward() {
 
     result.success = true;
     result.message = "Navigated forward.";
-    {
-        std::lock_guard<std::mutex> lock(global_state.console_mutex);
-        global_state.console_entries.clear();
-    }
+    clear_console_entries(*current_session_state());
     return result;
 }
 
 browser_driver::DriverResult refresh() {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "Failed to reload page.";
@@ -817,7 +1379,7 @@ browser_driver::DriverResult refresh() {
     }
 
     json reload_response = send_command("Page.reload", json::object(),
-                                        global_state.current_session_id);
+                                        active_session_id());
     if (reload_response.contains("error") && reload_response["error"].is_string()) {
         result.success = false;
         result.error_detail = reload_response["error"].get<std::string>();
@@ -827,24 +1389,21 @@ browser_driver::DriverResult refresh() {
 
     result.success = true;
     result.message = "Page reloaded.";
-    {
-        std::lock_guard<std::mutex> lock(global_state.console_mutex);
-        global_state.console_entries.clear();
-    }
+    clear_console_entries(*current_session_state());
     return result;
 }
 
 browser_driver::NavigationHistoryResult get_navigation_history() {
     browser_driver::NavigationHistoryResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
     }
 
     json history_response = send_command("Page.getNavigationHistory", json::object(),
-                                         global_state.current_session_id);
+                                         active_session_id());
     if (history_response.contains("error") && history_response["error"].is_string()) {
         result.success = false;
         result.error_detail = history_response["error"].get<std::string>();
@@ -876,10 +1435,31 @@ browser_driver::NavigationHistoryResult get_navigation_history() {
     return result;
 }
 
-browser_driver::DriverResult new_tab(const std::string &url) {
+browser_driver::DriverResult new_tab(const std::string &url, const std::string &browser_context_id) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected) {
+    // With several browsers in the pool, open the tab in the least loaded one (fewest tabs).
+    // A browser context belongs to the active browser, so such tabs stay there.
+    if (browser_context_id.empty() && browser_pool.size() > 1) {
+        std::map<ConnectionState *, size_t> tab_count_by_browser;
+        for (auto &browser : browser_pool) {
+            if (browser->connected) {
+                tab_count_by_browser[browser.get()] = 0;
+            }
+        }
+        for (const auto &pool_tab : pool_page_targets()) {
+            tab_count_by_browser[pool_tab.browser]++;
+        }
+        for (auto &browser : browser_pool) {
+            auto count_iterator = tab_count_by_browser.find(browser.get());
+            if (count_iterator != tab_count_by_browser.end() &&
+                (!active_browser->connected || count_iterator->second < tab_count_by_browser[active_browser])) {
+                active_browser = browser.get();
+            }
+        }
+    }
+
+    if (!active_browser->connected) {
         result.success = false;
         result.error_detail = "Not connected to a browser. Call open_browser first.";
         result.message = "Failed to create new tab.";
@@ -888,6 +1468,9 @@ browser_driver::DriverResult new_tab(const std::string &url) {
 
     json create_params;
     create_params["url"] = url.empty() ? "about:blank" : url;
+    if (!browser_context_id.empty()) {
+        create_params["browserContextId"] = browser_context_id;
+    }
     json create_response = send_command("Target.createTarget", create_params);
 
     if (!create_response.contains("result") || !create_response["result"].contains("targetId")) {
@@ -900,22 +1483,14 @@ browser_driver::DriverResult new_tab(const std::string &url) {
     std::string target_id = create_response["result"]["targetId"].get<std::string>();
     debug_log::log("new_tab: created targetId=" + target_id);
 
-    json attach_params;
-    attach_params["targetId"] = target_id;
-    attach_params["flatten"] = true;
-    json attach_response = send_command("Target.attachToTarget", attach_params);
-
-    if (!attach_response.contains("result") || !attach_response["result"].contains("sessionId")) {
+    std::string attach_error;
+    if (!attach_to_target(target_id, attach_error)) {
         result.success = false;
-        result.error_detail = "Target.attachToTarget failed: " + attach_response.dump();
+        result.error_detail = attach_error;
         result.message = "Failed to attach to new tab.";
         return result;
     }
 
-    global_state.current_target_id = target_id;
-    global_state.current_session_id = attach_response["result"]["sessionId"].get<std::string>();
-    enable_console_for_session();
-
     json activate_params;
     activate_params["targetId"] = target_id;
     json activate_response = send_command("Target.activateTarget", activate_params, "");
@@ -925,59 +1500,39 @@ browser_driver::DriverResult new_tab(const std::string &url) {
 
     result.success = true;
     result.message = "New tab opened and attached.";
-    debug_log::log("new_tab: attached sessionId=" + global_state.current_session_id);
+    debug_log::log("new_tab: attached sessionId=" + active_browser->current_session_id);
     return result;
 }
 
 browser_driver::DriverResult switch_tab(int index) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected) {
+    if (!active_browser->connected) {
         result.success = false;
         result.error_detail = "Not connected to a browser. Call open_browser first.";
         result.message = "Failed to switch tab.";
         return result;
     }
 
-    json get_targets_response = send_command("Target.getTargets", json::object());
-    if (!get_targets_response.contains("result") || !get_targets_response["result"].contains("targetInfos")) {
+    std::vector<PoolTab> pool_tabs = pool_page_targets();
+    if (index < 0 || index >= static_cast<int>(pool_tabs.size())) {
         result.success = false;
-        result.error_detail = "Target.getTargets failed: " + get_targets_response.dump();
+        result.error_detail = "Tab index " + std::to_string(index) + " out of range (0.." + std::to_string(pool_tabs.size() - 1) + ").";
         result.message = "Failed to switch tab.";
         return result;
     }
 
-    std::vector<std::string> page_target_ids;
-    for (const auto &target_info : get_targets_response["result"]["targetInfos"]) {
-        if (target_info.contains("type") && target_info["type"] == "page") {
-            page_target_ids.push_back(target_info["targetId"].get<std::string>());
-        }
-    }
-
-    if (index < 0 || index >= static_cast<int>(page_target_ids.size())) {
+    // The tab may live in another browser of the pool; that browser becomes the active one.
+    active_browser = pool_tabs[static_cast<size_t>(index)].browser;
+    std::string target_id = pool_tabs[static_cast<size_t>(index)].record.target_id;
+    std::string attach_error;
+    if (!attach_to_target(target_id, attach_error)) {
         result.success = false;
-        result.error_detail = "Tab index " + std::to_string(index) + " out of range (0.." + std::to_string(page_target_ids.size() - 1) + ").";
+        result.error_detail = attach_error;
         result.message = "Failed to switch tab.";
         return result;
     }
 
-    std::string target_id = page_target_ids[static_cast<size_t>(index)];
-    json attach_params;
-    attach_params["targetId"] = target_id;
-    attach_params["flatten"] = true;
-    json attach_response = send_command("Target.attachToTarget", attach_params);
-
-    if (!attach_response.contains("result") || !attach_response["result"].contains("sessionId")) {
-        result.success = false;
-        result.error_detail = "Target.attachToTarget failed: " + attach_response.dump();
-        result.message = "Failed to switch tab.";
-        return result;
-    }
-
-    global_state.current_target_id = target_id;
-    global_state.current_session_id = attach_response["result"]["sessionId"].get<std::string>();
-    enable_console_for_session();
-
     json activate_params;
     activate_params["targetId"] = target_id;
     json activate_response = send_command("Target.activateTarget", activate_params, "");
@@ -994,14 +1549,14 @@ browser_driver::DriverResult switch_tab(int index) {
 browser_driver::DriverResult close_tab() {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_target_id.empty()) {
+    if (!active_browser->connected || active_browser->current_target_id.empty()) {
         result.success = false;
         result.error_detail = "No current tab. Call open_browser and ensure a tab is selected.";
         result.message = "Failed to close tab.";
         return result;
     }
 
-    std::string tab_to_close = global_state.current_target_id;
+    std::string tab_to_close = active_browser->current_target_id;
     json close_params;
     close_params["targetId"] = tab_to_close;
     json close_response = send_command("Target.closeTarget", close_params);
@@ -1013,27 +1568,20 @@ browser_driver::DriverResult close_tab() {
         return result;
     }
 
-    global_state.current_target_id.clear();
-    global_state.current_session_id.clear();
+    remove_session_state(active_browser->current_session_id);
+    active_browser->current_target_id.clear();
+    active_browser->current_session_id.clear();
 
-    json get_targets_response = send_command("Target.getTargets", json::object());
-    if (get_targets_response.contains("result") && get_targets_response["result"].contains("targetInfos")) {
-        for (const auto &target_info : get_targets_response["result"]["targetInfos"]) {
-            if (target_info.contains("type") && target_info["type"] == "page" &&
-                target_info["targetId"] != tab_to_close) {
-                std::string other_id = target_info["targetId"].get<std::string>();
-                json attach_params;
-                attach_params["targetId"] = other_id;
-                attach_params["flatten"] = true;
-                json attach_response = send_command("Target.attachToTarget", attach_params);
-                if (attach_response.contains("result") && attach_response["result"].contains("sessionId")) {
-                    global_state.current_target_id = other_id;
-                    global_state.current_session_id = attach_response["result"]["sessionId"].get<std::string>();
-                    enable_console_for_session();
-                    debug_log::log("close_tab: attached to remaining tab targetId=" + other_id);
-                }
-                break;
-            }
+    // Drop the closed tab now; Target.targetDestroyed may arrive after we pick the next tab.
+    remove_target(tab_to_close);
+    std::vector<TargetRecord> remaining_targets = page_targets_snapshot();
+    if (!remaining_targets.empty()) {
+        std::string other_id = remaining_targets.front().target_id;
+        std::string attach_error;
+        if (attach_to_target(other_id, attach_error)) {
+            debug_log::log("close_tab: attached to remaining tab targetId=" + other_id);
+        } else {
+            debug_log::log("close_tab: " + attach_error);
         }
     }
 
@@ -1042,18 +1590,611 @@ browser_driver::DriverResult close_tab() {
     return result;
 }
 
+browser_driver::CreateBrowserContextResult create_browser_context() {
+    browser_driver::CreateBrowserContextResult result;
+
+    if (!active_browser->connected) {
+        result.success = false;
+        result.error_detail = "Not connected to a browser. Call open_browser first.";
+        result.message = "Failed to create browser context.";
+        return result;
+    }
+
+    json create_params;
+    create_params["disposeOnDetach"] = true;
+    json create_response = send_command("Target.createBrowserContext", create_params);
+    if (!create_response.contains("result") || !create_response["result"].contains("browserContextId")) {
+        result.success = false;
+        result.error_detail = "Target.createBrowserContext failed: " + create_response.dump();
+        result.message = "Failed to create browser context.";
+        return result;
+    }
+
+    result.browser_context_id = create_response["result"]["browserContextId"].get<std::string>();
+    debug_log::log("create_browser_context: browserContextId=" + result.browser_context_id);
+    result.success = true;
+    result.message = "Browser context created: " + result.browser_context_id;
+    return result;
+}
+
+browser_driver::DriverResult dispose_browser_context(const std::string &browser_context_id) {
+    browser_driver::DriverResult result;
+
+    if (!active_browser->connected) {
+        result.success = false;
+        result.error_detail = "Not connected to a browser. Call open_browser first.";
+        result.message = "Failed to dispose browser context.";
+        return result;
+    }
+
+    // Tabs of the context go away with it; collect them before the Target.targetDestroyed events.
+    std::vector<std::string> context_target_ids;
+    {
+        service_websocket(0);
+        std::lock_guard<std::mutex> lock(active_browser->target_mutex);
+        for (const auto &record : active_browser->targets) {
+            if (record.browser_context_id == browser_context_id) {
+                context_target_ids.push_back(record.target_id);
+            }
+        }
+    }
+
+    json dispose_params;
+    dispose_params["browserContextId"] = browser_context_id;
+    json dispose_response = send_command("Target.disposeBrowserContext", dispose_params);
+    if (dispose_response.contains("error")) {
+        result.success = false;
+        result.error_detail = "Target.disposeBrowserContext failed: " + dispose_response.dump();
+        result.message = "Failed to dispose browser context.";
+        return result;
+    }
+
+    bool current_closed = false;
+    for (const auto &target_id : context_target_ids) {
+        std::string session_id = find_session_for_target(target_id);
+        if (!session_id.empty()) {
+            remove_session_state(session_id);
+        }
+        remove_target(target_id);
+        if (target_id == active_browser->current_target_id) {
+            current_closed = true;
+        }
+    }
+
+    if (current_closed) {
+        active_browser->current_target_id.clear();
+        active_browser->current_session_id.clear();
+        std::vector<TargetRecord> remaining_targets = page_targets_snapshot();
+        if (!remaining_targets.empty()) {
+            std::string attach_error;
+            if (!attach_to_target(remaining_targets.front().target_id, attach_error)) {
+                debug_log::log("dispose_browser_context: " + attach_error);
+            }
+        }
+    }
+
+    result.success = true;
+    result.message = "Browser context disposed (" + std::to_string(context_target_ids.size()) + " tab(s) closed).";
+    return result;
+}
+
+// Browser that was active before route_to_tab moved the call to another pool member.
+static ConnectionState *browser_before_route = nullptr;
+
+bool route_to_tab(const std::string &tab_id, std::string &out_error) {
+    active_browser->routed_target_id.clear();
+    active_browser->routed_session_id.clear();
+    if (browser_before_route != nullptr) {
+        active_browser = browser_before_route;
+        browser_before_route = nullptr;
+    }
+    if (tab_id.empty()) {
+        return true;
+    }
+    if (!active_browser->connected) {
+        out_error = "No active browser. Call open_browser first.";
+        return false;
+    }
+
+    // tab_id is a target id from list_tabs, or a 0-based index into the tab list.
+    std::vector<PoolTab> pool_tabs = pool_page_targets();
+    const PoolTab *routed_tab = nullptr;
+    for (const auto &pool_tab : pool_tabs) {
+        if (pool_tab.record.target_id == tab_id) {
+            routed_tab = &pool_tab;
+            break;
+        }
+    }
+    if (routed_tab == nullptr &&
+        std::all_of(tab_id.begin(), tab_id.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        size_t index = pool_tabs.size();
+        try {
+            index = static_cast<size_t>(std::stoul(tab_id));
+        } catch (...) {
+            index = pool_tabs.size();  // out of range: reported as an unknown tab
+        }
+        if (index < pool_tabs.size()) {
+            routed_tab = &pool_tabs[index];
+        }
+    }
+    if (routed_tab == nullptr) {
+        out_error = "Unknown tab '" + tab_id + "'. Use a target id or index from list_tabs.";
+        return false;
+    }
+
+    if (routed_tab->browser != active_browser) {
+        browser_before_route = active_browser;
+        active_browser = routed_tab->browser;
+    }
+    std::string session_id;
+    if (!session_for_target(routed_tab->record.target_id, session_id, out_error)) {
+        if (browser_before_route != nullptr) {
+            active_browser = browser_before_route;
+            browser_before_route = nullptr;
+        }
+        return false;
+    }
+    active_browser->routed_target_id = routed_tab->record.target_id;
+    active_browser->routed_session_id = session_id;
+    enable_console_for_session();
+    return true;
+}
+
+static bool resolve_selector_object(const std::string &selector, std::string &out_object_id, std::string &out_error);
+
+// capture_screenshot fitting to the byte limit: captures per call, the quality floor and the WebP
+// quality used when a PNG is too large.
+static constexpr int kScreenshotFitAttempts = 4;
+static constexpr int kScreenshotFitMinQuality = 30;
+static constexpr int kScreenshotFitDefaultQuality = 80;
+
+// JPEG/WebP quality of the options in the range Page.captureScreenshot accepts (1-100).
+static int screenshot_quality(const browser_driver::CaptureScreenshotOptions &options) {
+    return std::min(std::max(options.quality, 1), 100);
+}
+
+// Page.captureScreenshot clip for the options' selector, region, scale and size caps. Clips are in
+// document CSS pixels: the viewport-relative rect is offset by the scroll position. The device pixel
+// ratio is read so max_width/max_height cap the real output size.
+static bool screenshot_clip(const browser_driver::CaptureScreenshotOptions &options, json &out_clip,
+                            std::string &out_error) {
+    double x = options.clip_x;
+    double y = options.clip_y;
+    double width = options.clip_width;
+    double height = options.clip_height;
+    if (!options.selector.empty()) {
+        std::string object_id;
+        if (!resolve_selector_object(options.selector, object_id, out_error)) {
+            return false;
+        }
+        json object_params;
+        object_params["objectId"] = object_id;
+        send_command("DOM.scrollIntoViewIfNeeded", object_params, active_session_id(), 5000);
+        json box_response = send_command("DOM.getBoxModel", object_params, active_session_id(), 5000);
+        if (!box_response.contains("result") || !box_response["result"].contains("model") ||
+            !box_response["result"]["model"].contains("border") ||
+            box_response["result"]["model"]["border"].size() != 8) {
+            out_error = "Element has no layout box: " + options.selector;
+            return false;
+        }
+        const json &quad = box_response["result"]["model"]["border"];
+        double right = x = quad[0].get<double>();
+        double bottom = y = quad[1].get<double>();
+        for (size_t index = 2; index < 8; index += 2) {
+            x = std::min(x, quad[index].get<double>());
+            right = std::max(right, quad[index].get<double>());
+            y = std::min(y, quad[index + 1].get<double>());
+            bottom = std::max(bottom, quad[index + 1].get<double>());
+        }
+        width = right - x;
+        height = bottom - y;
+        if (width <= 0 || height <= 0) {
+            out_error = "Element has an empty box: " + options.selector;
+            return false;
+        }
+    }
+
+    json ratio_params;
+    ratio_params["expression"] = "window.devicePixelRatio";
+    ratio_params["returnByValue"] = true;
+    int metrics_id = send_command_async("Page.getLayoutMetrics", json::object(), active_session_id());
+    int ratio_id = send_command_async("Runtime.evaluate", ratio_params, active_session_id());
+    json metrics_response = wait_for_response(metrics_id, "Page.getLayoutMetrics", 5000);
+    json ratio_response = wait_for_response(ratio_id, "Runtime.evaluate", 5000);
+    if (!metrics_response.contains("result") || !metrics_response["result"].contains("cssVisualViewport")) {
+        out_error = "Could not read the viewport size: " + metrics_response.dump();
+        return false;
+    }
+    const json &viewport = metrics_response["result"]["cssVisualViewport"];
+    double viewport_width = viewport.value("clientWidth", 0.0);
+    double viewport_height = viewport.value("clientHeight", 0.0);
+    if (width <= 0 || height <= 0) {
+        x = 0;
+        y = 0;
+        width = viewport_width;
+        height = viewport_height;
+    }
+    double device_pixel_ratio = 1.0;
+    if (ratio_response.contains("result") && ratio_response["result"].contains("result") &&
+        ratio_response["result"]["result"].contains("value") &&
+        ratio_response["result"]["result"]["value"].is_number()) {
+        device_pixel_ratio = std::max(0.1, ratio_response["result"]["result"]["value"].get<double>());
+    }
+
+    double scale = options.scale > 0 ? std::min(options.scale, 1.0) : 1.0;
+    if (options.max_width > 0 && width * scale * device_pixel_ratio > options.max_width) {
+        scale = options.max_width / (width * device_pixel_ratio);
+    }
+    if (options.max_height > 0 && height * scale * device_pixel_ratio > options.max_height) {
+        scale = options.max_height / (height * device_pixel_ratio);
+    }
+
+    out_clip = {{"x", x + viewport.value("pageX", 0.0)},
+                {"y", y + viewport.value("pageY", 0.0)},
+                {"width", width},
+                {"height", height},
+                {"scale", scale}};
+    return true;
+}
+
+// capture_screenshot mode=latest: first-frame wait after starting the screencast, and how long to
+// keep reading while newer frames are still arriving.
+static constexpr int kScreencastFirstFrameTimeoutMs = 2000;
+static constexpr int kScreencastSettleMs = 30;
+static constexpr int kScreencastSettleRounds = 3;
+
+// Newest screencast frame of the current tab. Starts the screencast (or restarts it when the
+// settings changed), then drains frames already sent. Chrome only sends a frame after a repaint and
+// our ack, so the slot is current unless the page is still painting: then read briefly for newer ones.
+// False = no frame within the timeout (the caller captures instead).
+static bool latest_screencast_frame(const browser_driver::CaptureScreenshotOptions &options, size_t max_bytes,
+                                    browser_driver::CaptureScreenshotResult &result) {
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    std::string format = options.format == "png" ? "png" : "jpeg";
+    int quality = screenshot_quality(options);
+    json screencast_params;
+    screencast_params["format"] = format;
+    if (format == "jpeg") {
+        screencast_params["quality"] = quality;
+    }
+    if (options.max_width > 0) {
+        screencast_params["maxWidth"] = options.max_width;
+    }
+    if (options.max_height > 0) {
+        screencast_params["maxHeight"] = options.max_height;
+    }
+    screencast_params["everyNthFrame"] = std::max(1, options.every_nth_frame);
+
+    bool restart = false;
+    {
+        std::lock_guard<std::mutex> lock(session_state->screencast_mutex);
+        restart = !session_state->screencast_running || session_state->screencast_settings != screencast_params.dump();
+    }
+    if (restart) {
+        json start_response = send_command("Page.startScreencast", screencast_params, active_session_id(), 5000);
+        if (start_response.contains("error")) {
+            debug_log::log("capture_screenshot: Page.startScreencast failed: " + start_response.dump());
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(session_state->screencast_mutex);
+        session_state->screencast_running = true;
+        session_state->screencast_settings = screencast_params.dump();
+        session_state->screencast_mime_type = "image/" + format;
+        session_state->screencast_frame_base64.clear();
+        session_state->screencast_frame_timestamp = 0;
+    }
+
+    auto frame_count = [&] {
+        std::lock_guard<std::mutex> lock(session_state->screencast_mutex);
+        return session_state->screencast_frame_count;
+    };
+    auto has_frame = [&] {
+        std::lock_guard<std::mutex> lock(session_state->screencast_mutex);
+        return !session_state->screencast_frame_base64.empty();
+    };
+    int frames_seen = frame_count();
+    service_websocket(0);
+    for (int round = 0; round < kScreencastSettleRounds && frame_count() != frames_seen; ++round) {
+        frames_seen = frame_count();
+        service_websocket(kScreencastSettleMs);
+    }
+    auto start_time = std::chrono::steady_clock::now();
+    while (!has_frame() && std::chrono::steady_clock::now() - start_time <
+                               std::chrono::milliseconds(kScreencastFirstFrameTimeoutMs)) {
+        service_websocket(10);
+    }
+
+    std::lock_guard<std::mutex> lock(session_state->screencast_mutex);
+    if (session_state->screencast_frame_base64.empty() ||
+        session_state->screencast_frame_base64.size() > max_bytes) {
+        return false;
+    }
+    result.image_base64 = session_state->screencast_frame_base64;
+    result.mime_type = session_state->screencast_mime_type;
+    result.quality = format == "jpeg" ? quality : 0;
+    result.from_screencast = true;
+    double now_seconds = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    result.frame_age_milliseconds =
+        std::max(0, static_cast<int>((now_seconds - session_state->screencast_frame_timestamp) * 1000));
+    result.success = true;
+    return true;
+}
+
+// capture_screenshot changes_only: diff tile size, and when to send the full image instead of crops.
+static constexpr int kScreenshotDiffTileSize = 32;
+static constexpr size_t kScreenshotDiffMaxRegions = 4;
+static constexpr double kScreenshotDiffMaxChangedShare = 0.5;
+
+// changes_only capture: a PNG of the same clip is decoded and compared with the tab's previous one.
+// Changed areas are cut out of that same decoded frame and encoded as PNG crops, so the crops show
+// exactly the pixels that were compared. The full image is sent when the baseline is new, most of
+// it changed, or the crops do not fit max_bytes; a rescaled full image also drops the baseline,
+// since later crop positions would not match what the client holds.
+static browser_driver::CaptureScreenshotResult capture_screenshot_changes(
+    const browser_driver::CaptureScreenshotOptions &options, size_t max_bytes) {
+    browser_driver::CaptureScreenshotResult result;
+    json clip;
+    if (!screenshot_clip(options, clip, result.error_detail)) {
+        result.success = false;
+        return result;
+    }
+    json png_params;
+    png_params["format"] = "png";
+    png_params["clip"] = clip;
+    json png_response = send_command("Page.captureScreenshot", png_params, active_session_id());
+    if (!png_response.contains("result") || !png_response["result"].contains("data") ||
+        !png_response["result"]["data"].is_string()) {
+        result.success = false;
+        result.error_detail = png_response.contains("error") ? png_response["error"].dump()
+                                                             : "Page.captureScreenshot did not return image data.";
+        return result;
+    }
+    const std::string &png_base64 = png_response["result"]["data"].get_ref<const std::string &>();
+    std::string png_bytes;
+    cdp_screenshot_diff::Image current;
+    if (!cdp_screenshot_diff::decode_base64(png_base64, png_bytes) ||
+        !cdp_screenshot_diff::decode_png(png_bytes, current, result.error_detail)) {
+        result.success = false;
+        result.error_detail = "Could not decode the screenshot for comparison: " + result.error_detail;
+        return result;
+    }
+
+    std::string key = options.selector + "|" + std::to_string(options.clip_x) + "," + std::to_string(options.clip_y) +
+                      "," + std::to_string(options.clip_width) + "," + std::to_string(options.clip_height) + "|" +
+                      std::to_string(options.scale) + "," + std::to_string(options.max_width) + "," +
+                      std::to_string(options.max_height);
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    bool comparable = session_state->last_screenshot_key == key &&
+                      session_state->last_screenshot.width == current.width &&
+                      session_state->last_screenshot.height == current.height;
+    std::vector<cdp_screenshot_diff::Region> regions;
+    if (comparable) {
+        regions = cdp_screenshot_diff::changed_regions(session_state->last_screenshot, current, kScreenshotDiffTileSize);
+    }
+    result.full_width = current.width;
+    result.full_height = current.height;
+
+    if (comparable && regions.empty()) {
+        result.success = true;
+        result.unchanged = true;
+        return result;
+    }
+    double changed_area = 0;
+    for (const auto &region : regions) {
+        changed_area += static_cast<double>(region.width) * region.height;
+    }
+    bool send_full = !comparable || regions.size() > kScreenshotDiffMaxRegions ||
+                     changed_area > kScreenshotDiffMaxChangedShare * result.full_width * result.full_height;
+
+    if (!send_full) {
+        size_t total_bytes = 0;
+        for (const auto &region : regions) {
+            browser_driver::ScreenshotRegion changed_region;
+            changed_region.x = region.x;
+            changed_region.y = region.y;
+            changed_region.width = region.width;
+            changed_region.height = region.height;
+            changed_region.image_base64 =
+                cdp_screenshot_diff::encode_base64(cdp_screenshot_diff::encode_png(current, region));
+            total_bytes += changed_region.image_base64.size();
+            result.changed_regions.push_back(std::move(changed_region));
+        }
+        send_full = total_bytes > max_bytes;
+    }
+    session_state->last_screenshot = std::move(current);
+    session_state->last_screenshot_key = key;
+    if (!send_full) {
+        result.mime_type = "image/png";
+        result.success = true;
+        return result;
+    }
+    result.changed_regions.clear();
+
+    // The compared PNG itself is sent when it fits, whatever the requested format.
+    if (png_base64.size() <= max_bytes) {
+        result.image_base64 = png_base64;
+        result.mime_type = "image/png";
+        result.success = true;
+        return result;
+    }
+    browser_driver::CaptureScreenshotOptions full_options = options;
+    full_options.changes_only = false;
+    browser_driver::CaptureScreenshotResult full_result = capture_screenshot(full_options);
+    if (!full_result.success || full_result.adapted) {
+        session_state->last_screenshot = cdp_screenshot_diff::Image();
+        session_state->last_screenshot_key.clear();
+    }
+    // Size of the image the client received: the fit loop may have downscaled the clip.
+    double received_scale = full_result.scale / std::max(0.01, clip.value("scale", 1.0));
+    full_result.full_width = static_cast<int>(std::lround(result.full_width * received_scale));
+    full_result.full_height = static_cast<int>(std::lround(result.full_height * received_scale));
+    return full_result;
+}
+
+// capture_screenshot full_page: tile cap (a bound for endless pages).
+static constexpr int kFullPageMaxTiles = 50;
+
+// full_page capture: the page content size comes from Page.getLayoutMetrics, then tiles are captured
+// top to bottom with captureBeyondViewport. Captures run one at a time: Chrome renders overlapping
+// beyond-viewport captures black. With output_directory each tile is decoded and written as soon
+// as it arrives, so only one tile is held in memory; otherwise tiles are returned up to max_bytes.
+static browser_driver::CaptureScreenshotResult capture_full_page(
+    const browser_driver::CaptureScreenshotOptions &options, size_t max_bytes) {
+    browser_driver::CaptureScreenshotResult result;
+    json metrics_response = send_command("Page.getLayoutMetrics", json::object(), active_session_id(), 5000);
+    if (!metrics_response.contains("result") || !metrics_response["result"].contains("cssContentSize") ||
+        !metrics_response["result"].contains("cssVisualViewport")) {
+        result.success = false;
+        result.error_detail = "Could not read the page size: " + metrics_response.dump();
+        return result;
+    }
+    const json &content_size = metrics_response["result"]["cssContentSize"];
+    result.page_width = std::ceil(content_size.value("width", 0.0));
+    result.page_height = std::ceil(content_size.value("height", 0.0));
+    double tile_height = options.tile_height > 0
+                             ? options.tile_height
+                             : metrics_response["result"]["cssVisualViewport"].value("clientHeight", 0.0);
+    if (result.page_width <= 0 || result.page_height <= 0 || tile_height <= 0) {
+        result.success = false;
+        result.error_detail = "The page has no content size.";
+        return result;
+    }
+
+    // Scale (scale, max_width/max_height per tile, device pixel ratio) as for a clip of one tile.
+    browser_driver::CaptureScreenshotOptions tile_options;
+    tile_options.clip_width = result.page_width;
+    tile_options.clip_height = tile_height;
+    tile_options.scale = options.scale;
+    tile_options.max_width = options.max_width;
+    tile_options.max_height = options.max_height;
+    json tile_clip;
+    if (!screenshot_clip(tile_options, tile_clip, result.error_detail)) {
+        result.success = false;
+        return result;
+    }
+
+    std::string format = options.format;
+    if (format != "png" && format != "jpeg" && format != "webp") {
+        format = "jpeg";
+    }
+    std::string extension = format == "jpeg" ? ".jpg" : "." + format;
+    // Files are named page_<capture time in epoch ms>_NNN.<ext>, so repeated captures into one directory do
+    // not overwrite each other.
+    std::string file_prefix;
+    if (!options.output_directory.empty()) {
+        if (!platform::ensure_directory(options.output_directory, result.error_detail)) {
+            result.success = false;
+            return result;
+        }
+        long long capture_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count();
+        file_prefix = options.output_directory + "/page_" + std::to_string(capture_time) + "_";
+    }
+    int quality = screenshot_quality(options);
+    size_t tile_byte_limit = get_cdp_rx_buffer_size();
+    size_t total_bytes = 0;
+    for (double y = 0; y < result.page_height; y += tile_height) {
+        if (static_cast<int>(result.tiles.size()) >= kFullPageMaxTiles) {
+            result.truncated = true;
+            break;
+        }
+        double height = std::min(tile_height, result.page_height - y);
+        json capture_params;
+        capture_params["format"] = format;
+        if (format != "png") {
+            capture_params["quality"] = quality;
+        }
+        capture_params["captureBeyondViewport"] = true;
+        capture_params["clip"] = {{"x", 0}, {"y", y}, {"width", result.page_width}, {"height", height},
+                                  {"scale", tile_clip.value("scale", 1.0)}};
+        json capture_response = send_command("Page.captureScreenshot", capture_params, active_session_id(), 30000);
+        if (!capture_response.contains("result") || !capture_response["result"].contains("data") ||
+            !capture_response["result"]["data"].is_string()) {
+            result.success = false;
+            result.error_detail = "Tile at y=" + std::to_string(static_cast<int>(y)) + " failed: " +
+                                  (capture_response.contains("error") ? capture_response["error"].dump()
+                                                                      : "no image data");
+            return result;
+        }
+
+        browser_driver::ScreenshotRegion tile;
+        tile.x = 0;
+        tile.y = static_cast<int>(y);
+        tile.width = static_cast<int>(result.page_width);
+        tile.height = static_cast<int>(std::ceil(height));
+        std::string &tile_base64 = capture_response["result"]["data"].get_ref<std::string &>();
+        if (tile_base64.size() > tile_byte_limit) {
+            result.success = false;
+            result.error_detail = "Tile too large (" + std::to_string(tile_base64.size()) + " bytes base64, maximum " +
+                                  std::to_string(tile_byte_limit) + "). Use a smaller tile_height, scale or quality.";
+            return result;
+        }
+        if (!options.output_directory.empty()) {
+            char index_text[16];
+            std::snprintf(index_text, sizeof(index_text), "%03d", static_cast<int>(result.tiles.size()));
+            tile.file_path = file_prefix + index_text + extension;
+            std::string image_bytes;
+            if (!cdp_screenshot_diff::decode_base64(tile_base64, image_bytes)) {
+                result.success = false;
+                result.error_detail = "Tile at y=" + std::to_string(tile.y) + " returned invalid base64 data.";
+                return result;
+            }
+            if (!platform::write_file_contents(tile.file_path, image_bytes)) {
+                result.success = false;
+                result.error_detail = "Could not write " + tile.file_path + ": " + std::strerror(errno) +
+                                      " (disk full or directory removed?)";
+                return result;
+            }
+        } else {
+            if (total_bytes + tile_base64.size() > max_bytes) {
+                result.truncated = true;
+                break;
+            }
+            total_bytes += tile_base64.size();
+            tile.image_base64 = std::move(tile_base64);
+        }
+        result.tiles.push_back(std::move(tile));
+    }
+
+    result.mime_type = "image/" + format;
+    result.quality = format == "png" ? 0 : quality;
+    result.scale = tile_clip.value("scale", 1.0);
+    result.success = !result.tiles.empty();
+    if (!result.success) {
+        result.error_detail = "The first tile alone exceeds the size limit (" + std::to_string(max_bytes) +
+                              " bytes). Use output_directory, a smaller tile_height, scale or quality.";
+    }
+    return result;
+}
+
+static void stop_screencast() {
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    {
+        std::lock_guard<std::mutex> lock(session_state->screencast_mutex);
+        if (!session_state->screencast_running) {
+            return;
+        }
+        session_state->screencast_running = false;
+        session_state->screencast_settings.clear();
+        session_state->screencast_frame_base64.clear();
+        session_state->screencast_frame_timestamp = 0;
+    }
+    send_command("Page.stopScreencast", json::object(), active_session_id(), 5000);
+}
+
 browser_driver::CaptureScreenshotResult capture_screenshot(
     const browser_driver::CaptureScreenshotOptions &options) {
     browser_driver::CaptureScreenshotResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
     }
 
     std::string format = options.format;
-    if (format != "png" && format != "jpeg") {
+    if (format != "png" && format != "jpeg" && format != "webp") {
         format = "jpeg";
     }
     int quality = options.quality;
@@ -1063,65 +2204,139 @@ browser_driver::CaptureScreenshotResult capture_screenshot(
     if (quality > 100) {
         quality = 100;
     }
-
-    json capture_params;
-    capture_params["format"] = format;
-    if (format == "jpeg") {
-        capture_params["quality"] = quality;
+    size_t max_bytes = get_cdp_rx_buffer_size();
+    if (options.max_bytes > 0) {
+        max_bytes = std::min(max_bytes, static_cast<size_t>(options.max_bytes));
+    }
+    if (options.mode == "stop") {
+        stop_screencast();
+        result.success = true;
+        return result;
+    }
+    if (options.mode == "latest") {
+        if (latest_screencast_frame(options, max_bytes, result)) {
+            return result;
+        }
+        debug_log::log("capture_screenshot: no screencast frame, capturing instead");
+    } else if (options.full_page) {
+        return capture_full_page(options, max_bytes);
+    } else if (options.changes_only) {
+        return capture_screenshot_changes(options, max_bytes);
     }
-    json capture_response = send_command("Page.captureScreenshot", capture_params,
-                                         global_state.current_session_id);
 
-    if (capture_response.contains("error") && capture_response["error"].is_string()) {
+    json clip;
+    bool needs_clip = !options.selector.empty() || (options.clip_width > 0 && options.clip_height > 0) ||
+                      (options.scale > 0 && options.scale < 1.0) || options.max_width > 0 || options.max_height > 0;
+    if (needs_clip && !screenshot_clip(options, clip, result.error_detail)) {
         result.success = false;
-        result.error_detail = capture_response["error"].get<std::string>();
         return result;
     }
 
-    if (capture_response.contains("result") && capture_response["result"].contains("data") &&
-        capture_response["result"]["data"].is_string()) {
+    // Over the byte limit: PNG is re-encoded as WebP, then quality is lowered in proportion to the
+    // overshoot; when that would go below the quality floor the image is downscaled as well.
+    // Each step is one re-capture.
+    for (int attempt = 1;; ++attempt) {
+        json capture_params;
+        capture_params["format"] = format;
+        if (format != "png") {
+            capture_params["quality"] = quality;
+        }
+        if (!clip.is_null()) {
+            capture_params["clip"] = clip;
+        }
+        json capture_response = send_command("Page.captureScreenshot", capture_params, active_session_id());
+
+        if (capture_response.contains("error") && capture_response["error"].is_string()) {
+            result.success = false;
+            result.error_detail = capture_response["error"].get<std::string>();
+            return result;
+        }
+        if (!capture_response.contains("result") || !capture_response["result"].contains("data") ||
+            !capture_response["result"]["data"].is_string()) {
+            result.success = false;
+            result.error_detail = "Page.captureScreenshot did not return image data.";
+            return result;
+        }
+
         result.image_base64 = capture_response["result"]["data"].get<std::string>();
-        result.mime_type = (format == "png") ? "image/png" : "image/jpeg";
+        result.mime_type = "image/" + format;
+        result.quality = (format == "png") ? 0 : quality;
+        result.scale = clip.is_null() ? 1.0 : clip.value("scale", 1.0);
         size_t payload_bytes = result.image_base64.size();
-        size_t max_bytes = get_cdp_rx_buffer_size();
-        if (payload_bytes > max_bytes) {
+        if (payload_bytes <= max_bytes) {
+            result.success = true;
+            debug_log::log("capture_screenshot: format=" + format + " quality=" + std::to_string(quality) +
+                           " attempt=" + std::to_string(attempt) + " captured " + std::to_string(payload_bytes) +
+                           " bytes base64");
+            return result;
+        }
+        if (attempt >= kScreenshotFitAttempts) {
             result.success = false;
             result.image_base64.clear();
             result.error_detail = "Screenshot too large (" + std::to_string(payload_bytes) +
                                   " bytes base64). Maximum allowed is " + std::to_string(max_bytes) +
-                                  " bytes. Reduce viewport size (e.g. resize_browser) or use JPEG with lower quality.";
+                                  " bytes. Capture a region (clip, selector), downscale (scale, max_width) or use JPEG with "
+                                  "lower quality.";
+            return result;
+        }
+
+        result.adapted = true;
+        double ratio = static_cast<double>(max_bytes) / static_cast<double>(payload_bytes);
+        if (format == "png") {
+            format = "webp";
+            quality = kScreenshotFitDefaultQuality;
         } else {
-            result.success = true;
-            debug_log::log("capture_screenshot: format=" + format + " quality=" + std::to_string(quality) +
-                           " captured " + std::to_string(payload_bytes) + " bytes base64");
+            int wanted_quality = static_cast<int>(quality * ratio * 0.9);
+            bool downscale = wanted_quality < kScreenshotFitMinQuality || quality <= kScreenshotFitMinQuality;
+            quality = std::max(kScreenshotFitMinQuality, wanted_quality);
+            if (downscale) {
+                if (clip.is_null()) {
+                    browser_driver::CaptureScreenshotOptions viewport_options;
+                    if (!screenshot_clip(viewport_options, clip, result.error_detail)) {
+                        result.success = false;
+                        result.image_base64.clear();
+                        return result;
+                    }
+                }
+                clip["scale"] = clip.value("scale", 1.0) * std::sqrt(ratio) * 0.9;
+            }
         }
-    } else {
-        result.success = false;
-        result.error_detail = "Page.captureScreenshot did not return image data.";
     }
-
-    return result;
 }
 
 void enable_console_for_session() {
-    {
-        std::lock_guard<std::mutex> lock(global_state.console_mutex);
-        global_state.console_entries.clear();
+    if (!active_browser->connected || active_session_id().empty()) {
+        return;
     }
-    if (global_state.connected && !global_state.current_session_id.empty()) {
-        json enable_response = send_command("Runtime.enable", json::object(),
-                                            global_state.current_session_id);
-        if (enable_response.contains("error") && enable_response["error"].is_string()) {
-            debug_log::log("enable_console_for_session: Runtime.enable failed: " +
-                           enable_response["error"].get<std::string>());
-        }
-        json page_enable_response = send_command("Page.enable", json::object(),
-                                                 global_state.current_session_id);
-        if (page_enable_response.contains("error") && page_enable_response["error"].is_string()) {
-            debug_log::log("enable_console_for_session: Page.enable failed: " +
-                           page_enable_response["error"].get<std::string>());
-        }
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    if (session_state->domains_enabled) {
+        return;
     }
+    json enable_response = send_command("Runtime.enable", json::object(),
+                                        active_session_id());
+    if (enable_response.contains("error") && enable_response["error"].is_string()) {
+        debug_log::log("enable_console_for_session: Runtime.enable failed: " +
+                       enable_response["error"].get<std::string>());
+    }
+    json page_enable_response = send_command("Page.enable", json::object(),
+                                             active_session_id());
+    if (page_enable_response.contains("error") && page_enable_response["error"].is_string()) {
+        debug_log::log("enable_console_for_session: Page.enable failed: " +
+                       page_enable_response["error"].get<std::string>());
+    }
+    // Lifecycle milestones (DOMContentLoaded, load, networkIdle, ...) for navigate / wait_for_navigation.
+    json lifecycle_params;
+    lifecycle_params["enabled"] = true;
+    send_command("Page.setLifecycleEventsEnabled", lifecycle_params, active_session_id());
+    // window.__bmcps in every new document of this target; existing ones get it on first use.
+    json runtime_params;
+    runtime_params["source"] = cdp_page_runtime::install_source();
+    json runtime_response = send_command("Page.addScriptToEvaluateOnNewDocument", runtime_params, active_session_id());
+    if (runtime_response.contains("error") && runtime_response["error"].is_string()) {
+        debug_log::log("enable_console_for_session: addScriptToEvaluateOnNewDocument failed: " +
+                       runtime_response["error"].get<std::string>());
+    }
+    session_state->domains_enabled = true;
 }
 
 namespace {
@@ -1155,7 +2370,7 @@ browser_driver::ConsoleMessagesResult get_console_messages(
 
     browser_driver::ConsoleMessagesResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
@@ -1165,7 +2380,7 @@ browser_driver::ConsoleMessagesResult get_console_messages(
     eval_params["expression"] = "Date.now()";
     auto time_before = std::chrono::steady_clock::now();
     json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 5000);
+                                      active_session_id(), 5000);
     auto time_after = std::chrono::steady_clock::now();
     result.time_sync.server_now_ms = static_cast<int64_t>(
         std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -1186,8 +2401,9 @@ browser_driver::ConsoleMessagesResult get_console_messages(
 
     std::vector<browser_driver::ConsoleEntry> entries_copy;
     {
-        std::lock_guard<std::mutex> lock(global_state.console_mutex);
-        entries_copy = global_state.console_entries;
+        std::shared_ptr<SessionState> session_state = current_session_state();
+        std::lock_guard<std::mutex> lock(session_state->console_mutex);
+        entries_copy.assign(session_state->console_entries.begin(), session_state->console_entries.end());
     }
 
     std::vector<browser_driver::ConsoleEntry> filtered;
@@ -1272,148 +2488,657 @@ browser_driver::ConsoleMessagesResult get_console_messages(
 }
 
 static void ensure_dom_enabled() {
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
+        return;
+    }
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    if (session_state->dom_enabled) {
         return;
     }
     json dom_enable_response = send_command("DOM.enable", json::object(),
-                                            global_state.current_session_id);
-    (void)dom_enable_response;
+                                            active_session_id());
+    session_state->dom_enabled = !dom_enable_response.contains("error");
+}
+
+// Document root nodeId of the current tab; fetched with DOM.getDocument only when not cached.
+// Returns 0 if the document is unavailable.
+static int document_node_id(bool refresh) {
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    if (!refresh) {
+        std::lock_guard<std::mutex> lock(session_state->dom_mutex);
+        if (session_state->document_node_id != 0) {
+            return session_state->document_node_id;
+        }
+    }
+    json get_doc_params;
+    get_doc_params["depth"] = 0;
+    json get_doc_response = send_command("DOM.getDocument", get_doc_params, active_session_id());
+    if (!get_doc_response.contains("result") || !get_doc_response["result"].contains("root")) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(session_state->dom_mutex);
+    session_state->document_node_id = get_doc_response["result"]["root"]["nodeId"].get<int>();
+    return session_state->document_node_id;
+}
+
+// Resolve selector to a nodeId (0 = not found) with one DOM.querySelector on the cached document
+// root; a stale cached root is refreshed once.
+static int query_selector_node_id(const std::string &selector) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int root_node_id = document_node_id(attempt > 0);
+        if (root_node_id == 0) {
+            return 0;
+        }
+        json query_params;
+        query_params["nodeId"] = root_node_id;
+        query_params["selector"] = selector;
+        json query_response = send_command("DOM.querySelector", query_params, active_session_id());
+        if (query_response.contains("error")) {
+            continue;  // root nodeId no longer valid (document replaced): refetch and retry
+        }
+        if (!query_response.contains("result") || !query_response["result"].contains("nodeId")) {
+            return 0;
+        }
+        return query_response["result"]["nodeId"].get<int>();
+    }
+    return 0;
+}
+
+// Element handles returned by list_interactive_elements: "@<generation>:<item id>" (in-page index)
+// or "@n<backendNodeId>" (snapshot listing).
+static bool is_element_handle(const std::string &selector) {
+    return !selector.empty() && selector[0] == '@';
+}
+
+// RemoteObjectId behind a handle, or false with a stale/invalid handle error. Index handles need
+// no round trip; snapshot handles are resolved with one DOM.resolveNode.
+static bool resolve_element_handle(const std::string &handle, std::string &out_object_id, std::string &out_error) {
+    if (handle.size() > 2 && handle[1] == 'n') {
+        int backend_node_id = 0;
+        try {
+            backend_node_id = std::stoi(handle.substr(2));
+        } catch (...) {
+            backend_node_id = 0;
+        }
+        if (backend_node_id <= 0) {
+            out_error = "Invalid element handle '" + handle + "'. Use a handle from list_interactive_elements.";
+            return false;
+        }
+        json resolve_params;
+        resolve_params["backendNodeId"] = backend_node_id;
+        resolve_params["objectGroup"] = kElementHandleObjectGroup;
+        json resolve_response = send_command("DOM.resolveNode", resolve_params, active_session_id(), 5000);
+        if (!resolve_response.contains("result") || !resolve_response["result"].contains("object") ||
+            !resolve_response["result"]["object"].contains("objectId")) {
+            out_error = "Stale element handle '" + handle + "' (the element was removed or the page changed). "
+                        "Call list_interactive_elements again.";
+            return false;
+        }
+        out_object_id = resolve_response["result"]["object"]["objectId"].get<std::string>();
+        return true;
+    }
+
+    int generation = -1;
+    int item_id = -1;
+    size_t colon = handle.find(':');
+    if (colon != std::string::npos) {
+        try {
+            generation = std::stoi(handle.substr(1, colon - 1));
+            item_id = std::stoi(handle.substr(colon + 1));
+        } catch (...) {
+            generation = -1;
+        }
+    }
+    if (generation < 0 || item_id < 0) {
+        out_error = "Invalid element handle '" + handle + "'. Use a handle from list_interactive_elements.";
+        return false;
+    }
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    std::lock_guard<std::mutex> lock(session_state->handle_mutex);
+    auto object_iterator = session_state->handle_object_id_by_item.find(item_id);
+    if (generation != session_state->handle_generation ||
+        object_iterator == session_state->handle_object_id_by_item.end()) {
+        out_error = "Stale element handle '" + handle + "' (the element was removed or the page changed). "
+                    "Call list_interactive_elements again.";
+        return false;
+    }
+    out_object_id = object_iterator->second;
+    return true;
+}
+
+// Runtime call failed because a navigation replaced the document (context destroyed or gone).
+static bool is_context_lost_response(const json &response) {
+    if (!response.contains("error")) {
+        return false;
+    }
+    const json &error = response["error"];
+    std::string message = error.is_object() ? error.value("message", std::string())
+                                            : (error.is_string() ? error.get<std::string>() : std::string());
+    return message.find("context was destroyed") != std::string::npos ||
+           message.find("Cannot find context") != std::string::npos ||
+           message.find("navigated or closed") != std::string::npos;
+}
+
+// Call a page function in the current frame with JSON arguments in one round trip.
+// With object_id (an element handle) the function runs with that element as `this`. Otherwise it
+// uses Runtime.callFunctionOn on the known execution context (switch_to_frame or main world) and
+// falls back to Runtime.evaluate of an inline call while no context id is known yet or after that
+// context was destroyed.
+// object_arguments (RemoteObjectIds, passed after arguments) need object_id or a known context.
+static json call_page_function(const std::string &function_declaration, const json &arguments,
+                               int timeout_milliseconds = 5000, const std::string &object_id = "",
+                               const std::vector<std::string> &object_arguments = {}) {
+    json call_arguments = json::array();
+    for (const auto &argument : arguments) {
+        call_arguments.push_back({{"value", argument}});
+    }
+    for (const auto &object_argument : object_arguments) {
+        call_arguments.push_back({{"objectId", object_argument}});
+    }
+    if (!object_id.empty()) {
+        // Element handle: call with the element as `this`, no lookup needed.
+        json call_params;
+        call_params["functionDeclaration"] = function_declaration;
+        call_params["objectId"] = object_id;
+        call_params["arguments"] = call_arguments;
+        call_params["returnByValue"] = true;
+        call_params["awaitPromise"] = true;
+        return send_command("Runtime.callFunctionOn", call_params, active_session_id(), timeout_milliseconds);
+    }
+
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    int context_id = 0;
+    {
+        std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+        context_id = session_state->current_execution_context_id != 0 ? session_state->current_execution_context_id
+                                                                      : session_state->main_world_context_id;
+    }
+
+    if (context_id != 0) {
+        json call_params;
+        call_params["functionDeclaration"] = function_declaration;
+        call_params["executionContextId"] = context_id;
+        call_params["arguments"] = call_arguments;
+        call_params["returnByValue"] = true;
+        call_params["awaitPromise"] = true;
+        json call_response = send_command("Runtime.callFunctionOn", call_params, active_session_id(),
+                                          timeout_milliseconds);
+        if (!is_context_lost_response(call_response)) {
+            // Success, or an error after which the function may already be running (a timeout):
+            // running it again could repeat a click or toggle, so the error is returned as-is.
+            return call_response;
+        }
+        // Context went away (navigation): forget it and evaluate instead.
+        std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+        if (session_state->main_world_context_id == context_id) {
+            session_state->main_world_context_id = 0;
+        }
+    }
+
+    std::string expression = "(" + function_declaration + ")(";
+    for (size_t index = 0; index < arguments.size(); index++) {
+        expression += (index > 0 ? "," : "") + arguments[index].dump();
+    }
+    expression += ")";
+    json eval_params;
+    eval_params["expression"] = expression;
+    eval_params["returnByValue"] = true;
+    eval_params["awaitPromise"] = true;
+    apply_frame_context(eval_params);
+    return send_command("Runtime.evaluate", eval_params, active_session_id(), timeout_milliseconds);
+}
+
+// Install window.__bmcps now in the current frame context (or the context owning object_id), for
+// documents that were created before Page.addScriptToEvaluateOnNewDocument or in other worlds.
+static void install_page_runtime(const std::string &object_id) {
+    json response = call_page_function("function() { return " + cdp_page_runtime::install_source() + "; }",
+                                       json::array(), 5000, object_id);
+    if (response.contains("error") || (response.contains("result") && response["result"].contains("exceptionDetails"))) {
+        debug_log::log("install_page_runtime failed: " + response.dump());
+    }
+}
+
+// Call the runtime helper __bmcps.<name> like call_page_function; installs the runtime and retries
+// once when the context does not have it yet.
+static json call_page_runtime(const std::string &name, const json &arguments, int timeout_milliseconds = 5000,
+                              const std::string &object_id = "",
+                              const std::vector<std::string> &object_arguments = {}) {
+    json response = call_page_function(cdp_page_runtime::call_declaration(name), arguments, timeout_milliseconds,
+                                       object_id, object_arguments);
+    if (cdp_page_runtime::is_missing_response(response)) {
+        install_page_runtime(object_id);
+        response = call_page_function(cdp_page_runtime::call_declaration(name), arguments, timeout_milliseconds,
+                                      object_id, object_arguments);
+    }
+    return response;
+}
+
+// Selectors the runtime engine (__bmcps.query) resolves rather than plain CSS: css=, text=, xpath=,
+// role= prefixes, XPath starting with //, quoted text and >> / >>> chains.
+static bool is_engine_selector(const std::string &selector) {
+    static const char *const kPrefixes[] = {"css=", "text=", "xpath=", "role=", "//", "(//", "\"", "'"};
+    for (const char *prefix : kPrefixes) {
+        if (selector.compare(0, std::strlen(prefix), prefix) == 0) {
+            return true;
+        }
+    }
+    return selector.find(">>") != std::string::npos;
+}
+
+// RemoteObjectId of the element an element handle or engine selector names, for DOM commands that
+// take an objectId. Engine selectors are resolved in the page in one Runtime.evaluate.
+static bool resolve_selector_object(const std::string &selector, std::string &out_object_id, std::string &out_error) {
+    if (is_element_handle(selector)) {
+        return resolve_element_handle(selector, out_object_id, out_error);
+    }
+    json eval_params;
+    eval_params["expression"] = cdp_page_runtime::call_expression("query", json::array({selector}));
+    eval_params["objectGroup"] = kElementHandleObjectGroup;
+    apply_frame_context(eval_params);
+    json eval_response = send_command("Runtime.evaluate", eval_params, active_session_id(), 5000);
+    if (cdp_page_runtime::is_missing_response(eval_response)) {
+        install_page_runtime("");
+        eval_response = send_command("Runtime.evaluate", eval_params, active_session_id(), 5000);
+    }
+    if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
+        const json &details = eval_response["result"]["exceptionDetails"];
+        std::string description = details.value("text", "");
+        if (details.contains("exception") && details["exception"].is_object()) {
+            description = details["exception"].value("description", description);
+        }
+        out_error = "Invalid selector '" + selector + "': " + description;
+        return false;
+    }
+    if (!eval_response.contains("result") || !eval_response["result"].contains("result") ||
+        !eval_response["result"]["result"].contains("objectId")) {
+        out_error = "Element not found: " + selector;
+        return false;
+    }
+    out_object_id = eval_response["result"]["result"]["objectId"].get<std::string>();
+    return true;
+}
+
+// Viewport point for a selector, resolved in one page call: scrolls the element into view,
+// hit-tests its center and maps iframe coordinates to the top-level viewport.
+struct ElementPoint {
+    bool found = false;
+    bool hittable = false;        // center is visible and hits the element (or a descendant)
+    bool clicked_in_page = false; // not hittable and click fallback requested: element.click() ran
+    bool has_box = false;         // non-zero size (hover/drag still target its center when covered)
+    std::string error;            // stale handle etc.; empty = plain "not found"
+    std::string not_actionable;   // actionability wait timed out: the check that still failed
+    int x = 0;
+    int y = 0;
+};
+
+// Actionability checks (__bmcps.actionable) for mouse actions.
+static const json &click_checks() {
+    static const json checks = {{"visible", true}, {"stable", true}, {"enabled", true}, {"hit", true}};
+    return checks;
+}
+
+static const json &pointer_checks() {
+    static const json checks = {{"visible", true}, {"stable", true}, {"hit", true}};
+    return checks;
+}
+
+// With timeout_milliseconds > 0 the page waits for the checks before measuring (no click fallback).
+static ElementPoint resolve_element_point(const std::string &selector, bool click_if_obscured,
+                                          const json &checks = json(), int timeout_milliseconds = 0) {
+    ElementPoint point;
+    std::string object_id;
+    if (is_element_handle(selector) && !resolve_element_handle(selector, object_id, point.error)) {
+        return point;
+    }
+    json wait;
+    if (timeout_milliseconds > 0) {
+        wait = {{"timeout", timeout_milliseconds}, {"checks", checks}};
+    }
+    json response = call_page_runtime("resolvePoint", json::array({selector, click_if_obscured, wait}),
+                                      5000 + std::max(timeout_milliseconds, 0), object_id);
+    if (!object_id.empty() && response.contains("error")) {
+        point.error = "Stale element handle '" + selector + "' (element no longer exists). "
+                      "Call list_interactive_elements again.";
+        return point;
+    }
+    if (!response.contains("result") || !response["result"].contains("result") ||
+        response["result"].contains("exceptionDetails")) {
+        return point;
+    }
+    const json &value = response["result"]["result"].value("value", json::object());
+    if (!value.is_object()) {
+        return point;
+    }
+    point.not_actionable = value.value("reason", "");
+    if (!value.value("found", false)) {
+        return point;
+    }
+    point.found = true;
+    point.hittable = value.value("hittable", false);
+    point.clicked_in_page = value.value("clicked", false);
+    if (value.contains("x") && value["x"].is_number() && value.contains("y") && value["y"].is_number()) {
+        point.x = static_cast<int>(value["x"].get<double>());
+        point.y = static_cast<int>(value["y"].get<double>());
+    }
+    point.has_box = value.value("width", 0.0) > 0 && value.value("height", 0.0) > 0;
+    return point;
+}
+
+// Error for a point that was not found or, after an actionability wait, not actionable.
+static std::string element_point_error(const std::string &selector, const ElementPoint &point,
+                                       int timeout_milliseconds) {
+    if (!point.error.empty()) {
+        return point.error;
+    }
+    if (!point.not_actionable.empty()) {
+        return "Element not actionable after " + std::to_string(timeout_milliseconds) + " ms (" +
+               point.not_actionable + "): " + selector;
+    }
+    return "Element not found: " + selector;
+}
+
+// Send Input.dispatchMouseEvent commands back to back, then collect the replies (one round trip total).
+static void dispatch_mouse_events(const std::vector<json> &mouse_events) {
+    std::vector<int> message_ids;
+    for (const auto &mouse_event : mouse_events) {
+        message_ids.push_back(send_command_async("Input.dispatchMouseEvent", mouse_event, active_session_id()));
+    }
+    for (int message_id : message_ids) {
+        wait_for_response(message_id, "Input.dispatchMouseEvent", 5000);
+    }
+}
+
+static json make_mouse_event(const std::string &type, int x, int y, const std::string &button = "",
+                             int click_count = 0) {
+    json mouse_event;
+    mouse_event["type"] = type;
+    mouse_event["x"] = x;
+    mouse_event["y"] = y;
+    if (!button.empty()) {
+        mouse_event["button"] = button;
+        mouse_event["clickCount"] = click_count;
+    }
+    return mouse_event;
 }
 
-browser_driver::ListInteractiveElementsResult list_interactive_elements() {
+browser_driver::ListInteractiveElementsResult list_interactive_elements(const std::string &since_token) {
     browser_driver::ListInteractiveElementsResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
     }
 
-    const char *script =
-        "(function(){"
-        "var max=100,sel='input,textarea,button,[role=button],a,option,[role=option]';"
-        "var nodes=document.querySelectorAll(sel);"
-        "var out=[],idx=0;"
-        "function esc(s){ if(!s)return''; return s.replace(/\\\\/g,'\\\\\\\\').replace(/\"/g,'\\\\\"').replace(/\\n/g,'\\\\n'); }"
-        "for(var i=0;i<nodes.length&&idx<max;i++){"
-        "var el=nodes[i];"
-        "if(!el.offsetParent&&el.tagName!=='INPUT'&&el.tagName!=='TEXTAREA'&&el.tagName!=='OPTION'&&el.getAttribute('role')!=='option')continue;"
-        "el.setAttribute('data-bmcps-id',String(idx));"
-        "var label='';"
-        "if(el.id){ var lbl=document.querySelector('label[for=\"'+el.id.replace(/\"/g,'\\\\\"')+'\"]'); if(lbl)label=(lbl.innerText||'').trim().substring(0,200); }"
-        "if(!label&&el.placeholder)label=el.placeholder;"
-        "if(!label&&el.getAttribute('aria-label'))label=el.getAttribute('aria-label')||'';"
-        "var role=el.getAttribute('role')||(el.tagName==='A'?'link':el.tagName.toLowerCase());"
-        "var text=(el.innerText||'').trim().substring(0,200);"
-        "out.push({selector:'[data-bmcps-id=\"'+idx+'\"]',role:role,label:label,placeholder:(el.placeholder||''),type:(el.type||''),text:text});"
-        "idx++;"
-        "}"
-        "return JSON.stringify(out);"
-        "})()";
+    // A full listing replaces the handle objects; a delta only adds to them.
+    int release_id = -1;
+    if (since_token.empty()) {
+        json release_params;
+        release_params["objectGroup"] = kElementHandleObjectGroup;
+        release_id = send_command_async("Runtime.releaseObjectGroup", release_params, active_session_id());
+    }
 
     json eval_params;
-    eval_params["expression"] = script;
-    eval_params["returnByValue"] = true;
-    json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 8000);
+    eval_params["expression"] =
+        cdp_page_runtime::call_expression("interactiveIndex", json::array({since_token, 100}));
+    eval_params["objectGroup"] = kElementHandleObjectGroup;
+    apply_frame_context(eval_params);
+    int eval_id = send_command_async("Runtime.evaluate", eval_params, active_session_id());
+    if (release_id >= 0) {
+        wait_for_response(release_id, "Runtime.releaseObjectGroup", 5000);
+    }
+    json eval_response = wait_for_response(eval_id, "Runtime.evaluate", 8000);
+    if (cdp_page_runtime::is_missing_response(eval_response)) {
+        install_page_runtime("");
+        eval_response = send_command("Runtime.evaluate", eval_params, active_session_id(), 8000);
+    }
 
     if (eval_response.contains("error") && eval_response["error"].is_string()) {
         result.success = false;
         result.error_detail = eval_response["error"].get<std::string>();
         return result;
     }
-    if (!eval_response.contains("result") || !eval_response["result"].contains("result")) {
+    if (!eval_response.contains("result") || !eval_response["result"].contains("result") ||
+        eval_response["result"].contains("exceptionDetails") ||
+        !eval_response["result"]["result"].contains("objectId")) {
         result.success = false;
-        result.error_detail = "Runtime.evaluate did not return a result.";
+        result.error_detail = "Runtime.evaluate did not return the element list.";
         return result;
     }
 
-    const auto &res = eval_response["result"]["result"];
-    if (!res.contains("value") || !res["value"].is_string()) {
+    json properties_params;
+    properties_params["objectId"] = eval_response["result"]["result"]["objectId"];
+    properties_params["ownProperties"] = true;
+    json properties_response = send_command("Runtime.getProperties", properties_params, active_session_id(), 8000);
+    if (!properties_response.contains("result") || !properties_response["result"].contains("result")) {
         result.success = false;
-        result.error_detail = "list_interactive_elements script did not return JSON string.";
+        result.error_detail = "Runtime.getProperties failed for the element list.";
         return result;
     }
 
-    std::string json_string = res["value"].get<std::string>();
-    try {
-        json array = json::parse(json_string);
-        for (const auto &item : array) {
-            browser_driver::InteractiveElement element;
-            if (item.contains("selector") && item["selector"].is_string()) {
-                element.selector = item["selector"].get<std::string>();
-            }
-            if (item.contains("role") && item["role"].is_string()) {
-                element.role = item["role"].get<std::string>();
-            }
-            if (item.contains("label") && item["label"].is_string()) {
-                element.label = item["label"].get<std::string>();
-            }
-            if (item.contains("placeholder") && item["placeholder"].is_string()) {
-                element.placeholder = item["placeholder"].get<std::string>();
-            }
-            if (item.contains("type") && item["type"].is_string()) {
-                element.type = item["type"].get<std::string>();
-            }
-            if (item.contains("text") && item["text"].is_string()) {
-                element.text = item["text"].get<std::string>();
-            }
-            utf8_sanitize::sanitize(element.selector);
-            utf8_sanitize::sanitize(element.role);
-            utf8_sanitize::sanitize(element.label);
-            utf8_sanitize::sanitize(element.placeholder);
-            utf8_sanitize::sanitize(element.type);
-            utf8_sanitize::sanitize(element.text);
-            result.elements.push_back(element);
+    std::string json_string;
+    std::map<int, std::string> object_id_by_position;
+    for (const auto &property : properties_response["result"]["result"]) {
+        std::string name = property.value("name", "");
+        if (!property.contains("value")) {
+            continue;
+        }
+        const json &property_value = property["value"];
+        if (name == "meta" && property_value.contains("value") && property_value["value"].is_string()) {
+            json_string = property_value["value"].get<std::string>();
+        } else if (!name.empty() && std::all_of(name.begin(), name.end(), ::isdigit) &&
+                   property_value.contains("objectId")) {
+            object_id_by_position[std::stoi(name)] = property_value["objectId"].get<std::string>();
         }
+    }
+
+    json meta;
+    try {
+        meta = json::parse(json_string);
     } catch (const json::parse_error &) {
         result.success = false;
         result.error_detail = "Failed to parse list_interactive_elements JSON.";
         return result;
     }
+    if (!meta.is_object() || !meta.contains("items") || !meta["items"].is_array()) {
+        result.success = false;
+        result.error_detail = "list_interactive_elements script returned no items.";
+        return result;
+    }
+
+    result.version_token = meta.value("token", "");
+    result.is_delta = meta.value("delta", false);
+    result.truncated = meta.value("truncated", false);
+
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    std::lock_guard<std::mutex> lock(session_state->handle_mutex);
+    // Item ids are per document: a new document starts a new handle generation.
+    std::string document_id = meta.value("document", "");
+    if (document_id != session_state->handle_document_id) {
+        session_state->handle_document_id = document_id;
+        session_state->handle_generation++;
+        session_state->handle_object_id_by_item.clear();
+    } else if (!result.is_delta) {
+        session_state->handle_object_id_by_item.clear();  // the object group was just released
+    }
+    std::string handle_prefix = "@" + std::to_string(session_state->handle_generation) + ":";
+
+    if (meta.contains("removed") && meta["removed"].is_array()) {
+        for (const auto &removed_id : meta["removed"]) {
+            if (removed_id.is_number_integer()) {
+                session_state->handle_object_id_by_item.erase(removed_id.get<int>());
+                result.removed_selectors.push_back(handle_prefix + std::to_string(removed_id.get<int>()));
+            }
+        }
+    }
+
+    int position = 0;
+    for (const auto &item : meta["items"]) {
+        int item_id = item.value("id", -1);
+        auto object_iterator = object_id_by_position.find(position++);
+        if (item_id < 0 || object_iterator == object_id_by_position.end()) {
+            continue;
+        }
+        session_state->handle_object_id_by_item[item_id] = object_iterator->second;
+
+        browser_driver::InteractiveElement element;
+        element.selector = handle_prefix + std::to_string(item_id);
+        if (item.contains("role") && item["role"].is_string()) {
+            element.role = item["role"].get<std::string>();
+        }
+        if (item.contains("label") && item["label"].is_string()) {
+            element.label = item["label"].get<std::string>();
+        }
+        if (item.contains("placeholder") && item["placeholder"].is_string()) {
+            element.placeholder = item["placeholder"].get<std::string>();
+        }
+        if (item.contains("type") && item["type"].is_string()) {
+            element.type = item["type"].get<std::string>();
+        }
+        if (item.contains("text") && item["text"].is_string()) {
+            element.text = item["text"].get<std::string>();
+        }
+        utf8_sanitize::sanitize(element.role);
+        utf8_sanitize::sanitize(element.label);
+        utf8_sanitize::sanitize(element.placeholder);
+        utf8_sanitize::sanitize(element.type);
+        utf8_sanitize::sanitize(element.text);
+        result.elements.push_back(element);
+    }
 
     result.success = true;
     return result;
 }
 
+browser_driver::ListInteractiveElementsResult list_interactive_elements_snapshot(int cursor, bool viewport_only) {
+    browser_driver::ListInteractiveElementsResult result;
+
+    if (!active_browser->connected || active_session_id().empty()) {
+        result.success = false;
+        result.error_detail = "No active browser session. Call open_browser first.";
+        return result;
+    }
+
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    bool reuse_snapshot = false;
+    if (cursor > 0) {
+        std::lock_guard<std::mutex> lock(session_state->dom_mutex);
+        reuse_snapshot = session_state->snapshot_elements_valid &&
+                         session_state->snapshot_viewport_only == viewport_only;
+    }
+
+    if (!reuse_snapshot) {
+        json snapshot_params;
+        snapshot_params["computedStyles"] = cdp_dom_snapshot::required_computed_styles();
+        int snapshot_id = send_command_async("DOMSnapshot.captureSnapshot", snapshot_params, active_session_id());
+        int metrics_id = viewport_only ? send_command_async("Page.getLayoutMetrics", json::object(), active_session_id())
+                                       : -1;
+        json snapshot_response = wait_for_response(snapshot_id, "DOMSnapshot.captureSnapshot", 15000);
+
+        double viewport_width = 0;
+        double viewport_height = 0;
+        if (metrics_id >= 0) {
+            json metrics_response = wait_for_response(metrics_id, "Page.getLayoutMetrics", 5000);
+            if (metrics_response.contains("result") && metrics_response["result"].contains("cssLayoutViewport")) {
+                const json &layout_viewport = metrics_response["result"]["cssLayoutViewport"];
+                viewport_width = layout_viewport.value("clientWidth", 0.0);
+                viewport_height = layout_viewport.value("clientHeight", 0.0);
+            }
+        }
+
+        if (!snapshot_response.contains("result") || !snapshot_response["result"].contains("documents")) {
+            result.success = false;
+            result.error_detail = "DOMSnapshot.captureSnapshot failed: " + snapshot_response.dump();
+            return result;
+        }
+
+        std::vector<cdp_dom_snapshot::SnapshotElement> elements =
+            cdp_dom_snapshot::extract_interactive_elements(snapshot_response["result"], viewport_width, viewport_height);
+        if (viewport_only) {
+            elements.erase(std::remove_if(elements.begin(), elements.end(),
+                                          [](const cdp_dom_snapshot::SnapshotElement &element) {
+                                              return !element.in_viewport;
+                                          }),
+                           elements.end());
+        }
+
+        std::lock_guard<std::mutex> lock(session_state->dom_mutex);
+        session_state->snapshot_elements = std::move(elements);
+        session_state->snapshot_elements_valid = true;
+        session_state->snapshot_viewport_only = viewport_only;
+    }
+
+    std::lock_guard<std::mutex> lock(session_state->dom_mutex);
+    const std::vector<cdp_dom_snapshot::SnapshotElement> &elements = session_state->snapshot_elements;
+    int total_count = static_cast<int>(elements.size());
+    int begin = std::min(std::max(cursor, 0), total_count);
+    int end = std::min(begin + kSnapshotPageSize, total_count);
+    for (int position = begin; position < end; ++position) {
+        browser_driver::InteractiveElement element = elements[position].element;
+        element.selector = "@n" + std::to_string(elements[position].backend_node_id);
+        utf8_sanitize::sanitize(element.role);
+        utf8_sanitize::sanitize(element.label);
+        utf8_sanitize::sanitize(element.placeholder);
+        utf8_sanitize::sanitize(element.type);
+        utf8_sanitize::sanitize(element.text);
+        result.elements.push_back(element);
+    }
+    result.total_count = total_count;
+    result.next_cursor = end < total_count ? end : -1;
+    result.truncated = end < total_count;
+    result.success = true;
+    return result;
+}
+
 browser_driver::DriverResult fill_field(const std::string &selector, const std::string &value,
-                                        bool clear_first) {
+                                        bool clear_first, int timeout_milliseconds) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "fill_field failed.";
         return result;
     }
 
-    std::string escaped_selector = json(selector).dump();
-    std::string escaped_value = json(value).get<std::string>();
-
-    std::string focus_script = "var el=document.querySelector(" + escaped_selector + ");"
-        "if(!el){ throw new Error('Element not found: ' + " + escaped_selector + "); }"
-        "el.focus();";
-    if (clear_first) {
-        focus_script += "el.value='';"
-            "el.dispatchEvent(new Event('input',{bubbles:true}));"
-            "el.dispatchEvent(new Event('change',{bubbles:true}));";
+    std::string object_id;
+    if (is_element_handle(selector) && !resolve_element_handle(selector, object_id, result.error_detail)) {
+        result.success = false;
+        result.message = "fill_field failed.";
+        return result;
     }
 
-    json eval_params;
-    eval_params["expression"] = focus_script;
-    json focus_response = send_command("Runtime.evaluate", eval_params,
-                                       global_state.current_session_id, 5000);
-    if (focus_response.contains("result") && focus_response["result"].contains("exceptionDetails")) {
+    json wait;
+    if (timeout_milliseconds > 0) {
+        wait = {{"timeout", timeout_milliseconds}};
+    }
+    json focus_response = call_page_runtime("focusField", json::array({selector, clear_first, wait}),
+                                            5000 + std::max(timeout_milliseconds, 0), object_id);
+    if (focus_response.contains("error") ||
+        (focus_response.contains("result") && focus_response["result"].contains("exceptionDetails"))) {
         result.success = false;
-        result.error_detail = "Element not found or focus failed: " + selector;
+        result.error_detail = object_id.empty() || !focus_response.contains("error")
+                                  ? "Element not found or focus failed: " + selector
+                                  : "Stale element handle '" + selector + "' (element no longer exists). "
+                                    "Call list_interactive_elements again.";
         result.message = "fill_field failed.";
         return result;
     }
+    if (focus_response.contains("result") && focus_response["result"].contains("result")) {
+        const json &focus_value = focus_response["result"]["result"].value("value", json::object());
+        if (focus_value.is_object() && focus_value.contains("reason")) {
+            result.success = false;
+            result.error_detail = "Field not fillable after " + std::to_string(timeout_milliseconds) + " ms (" +
+                                  focus_value.value("reason", "") + "): " + selector;
+            result.message = "fill_field failed.";
+            return result;
+        }
+    }
 
     json insert_params;
     insert_params["text"] = value;
     json insert_response = send_command("Input.insertText", insert_params,
-                                        global_state.current_session_id, 5000);
+                                        active_session_id(), 5000);
     if (insert_response.contains("error") && insert_response["error"].is_string()) {
         result.success = false;
         result.error_detail = insert_response["error"].get<std::string>();
@@ -1426,112 +3151,112 @@ browser_driver::DriverResult fill_field(const std::string &selector, const std::
     return result;
 }
 
-browser_driver::DriverResult click_element(const std::string &selector) {
-    browser_driver::DriverResult result;
+// --- fill_form ---
+
+browser_driver::FillFormResult fill_form(const std::vector<browser_driver::FormField> &fields) {
+    browser_driver::FillFormResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
-        result.message = "click_element failed.";
         return result;
     }
 
-    ensure_dom_enabled();
-
-    json get_doc_response = send_command("DOM.getDocument", json::object(),
-                                         global_state.current_session_id);
-    if (!get_doc_response.contains("result") || !get_doc_response["result"].contains("root")) {
-        result.success = false;
-        result.error_detail = "DOM.getDocument failed.";
-        result.message = "click_element failed.";
-        return result;
+    // Handles travel as object arguments after the field list; each field names its argument index.
+    json page_fields = json::array();
+    std::vector<std::string> handle_object_ids;
+    std::vector<std::string> object_id_by_field(fields.size());
+    std::vector<int> page_index_by_field(fields.size(), -1);
+    result.fields.resize(fields.size());
+    for (size_t index = 0; index < fields.size(); index++) {
+        const browser_driver::FormField &field = fields[index];
+        result.fields[index].selector = field.selector;
+        json page_field;
+        page_field["selector"] = field.selector;
+        if (field.is_boolean) {
+            page_field["value"] = field.checked;
+        } else if (!field.values.empty()) {
+            page_field["value"] = field.values;
+        } else {
+            page_field["value"] = field.value;
+        }
+        page_field["type"] = field.type_text;
+        if (is_element_handle(field.selector)) {
+            if (!resolve_element_handle(field.selector, object_id_by_field[index], result.fields[index].error_detail)) {
+                continue;
+            }
+            page_field["element"] = static_cast<int>(handle_object_ids.size());
+            handle_object_ids.push_back(object_id_by_field[index]);
+        }
+        page_index_by_field[index] = static_cast<int>(page_fields.size());
+        page_fields.push_back(page_field);
     }
-    int root_node_id = get_doc_response["result"]["root"]["nodeId"].get<int>();
 
-    json query_params;
-    query_params["nodeId"] = root_node_id;
-    query_params["selector"] = selector;
-    json query_response = send_command("DOM.querySelector", query_params,
-                                       global_state.current_session_id);
-    if (!query_response.contains("result") || query_response["result"]["nodeId"].get<int>() == 0) {
-        std::string click_script = "var el=document.querySelector(" + json(selector).dump() + ");"
-            "if(!el)throw new Error('Not found'); el.click();";
-        json eval_params;
-        eval_params["expression"] = click_script;
-        json eval_response = send_command("Runtime.evaluate", eval_params,
-                                          global_state.current_session_id, 5000);
-        if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
+    json outcomes = json::array();
+    if (!page_fields.empty()) {
+        json response = call_page_runtime("fillForm", json::array({page_fields}), 10000,
+                                          handle_object_ids.empty() ? "" : handle_object_ids[0], handle_object_ids);
+        if (response.contains("error") || !response.contains("result") || !response["result"].contains("result") ||
+            response["result"].contains("exceptionDetails")) {
             result.success = false;
-            result.error_detail = "Element not found: " + selector;
-            result.message = "click_element failed.";
+            result.error_detail = "fill_form page call failed: " + response.dump();
             return result;
         }
-        result.success = true;
-        result.message = "Clicked (fallback).";
-        return result;
+        outcomes = response["result"]["result"].value("value", json::array());
     }
 
-    int node_id = query_response["result"]["nodeId"].get<int>();
-    json box_params;
-    box_params["nodeId"] = node_id;
-    json box_response = send_command("DOM.getBoxModel", box_params,
-                                     global_state.current_session_id);
-    if (!box_response.contains("result") || !box_response["result"].contains("model") ||
-        !box_response["result"]["model"].contains("content")) {
-        std::string click_script = "var el=document.querySelector(" + json(selector).dump() + ");"
-            "if(!el)throw new Error('Not found'); el.click();";
-        json eval_params;
-        eval_params["expression"] = click_script;
-        json eval_response = send_command("Runtime.evaluate", eval_params,
-                                          global_state.current_session_id, 5000);
-        if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
-            result.success = false;
-            result.error_detail = "Element not found or no box model: " + selector;
-            result.message = "click_element failed.";
-            return result;
+    for (size_t index = 0; index < fields.size(); index++) {
+        browser_driver::FillFormFieldResult &field_result = result.fields[index];
+        int page_index = page_index_by_field[index];
+        if (page_index < 0) {
+            continue;  // stale handle, error already set
         }
-        result.success = true;
-        result.message = "Clicked (fallback).";
-        return result;
+        json outcome = page_index < static_cast<int>(outcomes.size()) ? outcomes[page_index] : json::object();
+        if (outcome.contains("error")) {
+            field_result.error_detail = outcome.value("error", "failed");
+            continue;
+        }
+        if (outcome.value("typing", false)) {
+            // Focus and clear, then type: one page call and one Input.insertText for this field only.
+            json focus_response = call_page_runtime("focusField", json::array({fields[index].selector, true}), 5000,
+                                                    object_id_by_field[index]);
+            if (focus_response.contains("error") ||
+                (focus_response.contains("result") && focus_response["result"].contains("exceptionDetails"))) {
+                field_result.error_detail = "focus failed";
+                continue;
+            }
+            json insert_params;
+            insert_params["text"] = fields[index].value;
+            json insert_response = send_command("Input.insertText", insert_params, active_session_id(), 5000);
+            if (insert_response.contains("error")) {
+                field_result.error_detail = "Input.insertText failed";
+                continue;
+            }
+            field_result.typed = true;
+        }
+        field_result.success = true;
+        result.filled_count++;
     }
+    result.success = true;
+    return result;
+}
 
-    const auto &content = box_response["result"]["model"]["content"];
-    double left = content[0].get<double>();
-    double top = content[1].get<double>();
-    double right = content[4].get<double>();
-    double bottom = content[5].get<double>();
-    int x = static_cast<int>((left + right) / 2);
-    int y = static_cast<int>((top + bottom) / 2);
-
-    json mouse_press;
-    mouse_press["type"] = "mousePressed";
-    mouse_press["x"] = x;
-    mouse_press["y"] = y;
-    mouse_press["button"] = "left";
-    mouse_press["clickCount"] = 1;
-    json mouse_release;
-    mouse_release["type"] = "mouseReleased";
-    mouse_release["x"] = x;
-    mouse_release["y"] = y;
-    mouse_release["button"] = "left";
-    mouse_release["clickCount"] = 1;
-
-    json press_response = send_command("Input.dispatchMouseEvent", mouse_press,
-                                       global_state.current_session_id);
-    json release_response = send_command("Input.dispatchMouseEvent", mouse_release,
-                                        global_state.current_session_id);
-    (void)press_response;
-    (void)release_response;
+static browser_driver::DriverResult click_element_with_options(const std::string &selector,
+                                                               const std::string &button,
+                                                               int click_count, int timeout_milliseconds);
 
-    result.success = true;
-    result.message = "Clicked.";
+browser_driver::DriverResult click_element(const std::string &selector, int timeout_milliseconds) {
+    browser_driver::DriverResult result = click_element_with_options(selector, "left", 1, timeout_milliseconds);
+    if (!result.success) {
+        result.message = "click_element failed.";
+    }
     return result;
 }
 
 browser_driver::DriverResult click_at_coordinates(int x, int y) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "click_at_coordinates failed.";
@@ -1552,9 +3277,9 @@ browser_driver::DriverResult click_at_coordinates(int x, int y) {
     mouse_release["clickCount"] = 1;
 
     json press_response = send_command("Input.dispatchMouseEvent", mouse_press,
-                                       global_state.current_session_id);
+                                       active_session_id());
     json release_response = send_command("Input.dispatchMouseEvent", mouse_release,
-                                        global_state.current_session_id);
+                                        active_session_id());
     (void)press_response;
     (void)release_response;
 
@@ -1566,7 +3291,7 @@ browser_driver::DriverResult click_at_coordinates(int x, int y) {
 browser_driver::DriverResult scroll(const browser_driver::ScrollScope &scroll_scope) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "scroll failed.";
@@ -1581,7 +3306,7 @@ browser_driver::DriverResult scroll(const browser_driver::ScrollScope &scroll_sc
         json eval_params;
         eval_params["expression"] = script;
         json eval_response = send_command("Runtime.evaluate", eval_params,
-                                          global_state.current_session_id, 5000);
+                                          active_session_id(), 5000);
         if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
             result.success = false;
             result.error_detail = "window.scrollBy failed.";
@@ -1589,15 +3314,19 @@ browser_driver::DriverResult scroll(const browser_driver::ScrollScope &scroll_sc
             return result;
         }
     } else {
-        std::string escaped_selector = json(scroll_scope.selector).dump();
-        std::string script = "var el=document.querySelector(" + escaped_selector + ");"
-            "if(!el)throw new Error('Element not found');"
-            "el.scrollBy(" + std::to_string(delta_x) + "," + std::to_string(delta_y) + ");";
-        json eval_params;
-        eval_params["expression"] = script;
-        json eval_response = send_command("Runtime.evaluate", eval_params,
-                                          global_state.current_session_id, 5000);
-        if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
+        std::string object_id;
+        if (is_element_handle(scroll_scope.selector) &&
+            !resolve_element_handle(scroll_scope.selector, object_id, result.error_detail)) {
+            result.success = false;
+            result.message = "scroll failed.";
+            return result;
+        }
+        json eval_response = call_page_runtime("scrollElement", json::array({scroll_scope.selector, delta_x, delta_y}),
+                                               5000, object_id);
+        bool scrolled = eval_response.contains("result") && eval_response["result"].contains("result") &&
+                        !eval_response["result"].contains("exceptionDetails") &&
+                        eval_response["result"]["result"].value("value", false);
+        if (!scrolled) {
             result.success = false;
             result.error_detail = "Element not found or scroll failed: " + scroll_scope.selector;
             result.message = "scroll failed.";
@@ -1613,7 +3342,7 @@ browser_driver::DriverResult scroll(const browser_driver::ScrollScope &scroll_sc
 browser_driver::DriverResult set_window_bounds(int width, int height) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_target_id.empty()) {
+    if (!active_browser->connected || active_target_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser. Call open_browser first.";
         result.message = "set_window_bounds failed.";
@@ -1621,7 +3350,7 @@ browser_driver::DriverResult set_window_bounds(int width, int height) {
     }
 
     json get_window_params;
-    get_window_params["targetId"] = global_state.current_target_id;
+    get_window_params["targetId"] = active_target_id();
     json get_window_response = send_command("Browser.getWindowForTarget", get_window_params, "", 5000);
 
     if (!get_window_response.contains("result") || !get_window_response["result"].contains("windowId")) {
@@ -1655,25 +3384,113 @@ browser_driver::DriverResult set_window_bounds(int width, int height) {
 
 // --- evaluate_javascript ---
 
+// Run a script that was evaluated before in the same execution context through its cached
+// Runtime.compileScript scriptId, so V8 skips parsing and compiling it again. The first run of a
+// script only records its hash. The second sends Runtime.compileScript and Runtime.evaluate in one
+// pipelined burst (a scriptId is not known before the compile answers), so the repeat costs no
+// extra round trip; later runs use Runtime.runScript. Returns null when the caller should use
+// Runtime.evaluate instead (first run, unknown context, context gone).
+static json run_compiled_script(const std::string &script, int timeout_milliseconds) {
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    size_t script_hash = std::hash<std::string>()(script);
+    int context_id = 0;
+    std::string script_id;
+    {
+        std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+        context_id = session_state->current_execution_context_id != 0 ? session_state->current_execution_context_id
+                                                                      : session_state->main_world_context_id;
+        if (context_id == 0) {
+            return json();
+        }
+        std::map<size_t, CompiledScript> &script_ids = session_state->script_ids_by_context[context_id];
+        auto script_iterator = script_ids.find(script_hash);
+        if (script_iterator == script_ids.end()) {
+            if (script_ids.size() >= SessionState::kCompiledScriptsMax) {
+                script_ids.clear();
+            }
+            script_ids.emplace(script_hash, CompiledScript());
+            return json();
+        }
+        if (!script_iterator->second.script_id.empty() && script_iterator->second.source != script) {
+            return json();  // hash collision with another compiled script
+        }
+        script_id = script_iterator->second.script_id;
+    }
+
+    auto forget_script = [&]() {
+        std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+        auto context_iterator = session_state->script_ids_by_context.find(context_id);
+        if (context_iterator != session_state->script_ids_by_context.end()) {
+            context_iterator->second.erase(script_hash);
+        }
+    };
+
+    if (script_id.empty()) {
+        json compile_params;
+        compile_params["expression"] = script;
+        compile_params["sourceURL"] = "";
+        compile_params["persistScript"] = true;
+        compile_params["executionContextId"] = context_id;
+        json eval_params;
+        eval_params["expression"] = script;
+        eval_params["returnByValue"] = true;
+        eval_params["contextId"] = context_id;
+        int compile_id = send_command_async("Runtime.compileScript", compile_params, active_session_id());
+        int eval_id = send_command_async("Runtime.evaluate", eval_params, active_session_id());
+        json compile_response = wait_for_response(compile_id, "Runtime.compileScript", 5000);
+        json eval_response = wait_for_response(eval_id, "Runtime.evaluate", timeout_milliseconds);
+        if (!compile_response.contains("result") || !compile_response["result"].contains("scriptId") ||
+            !compile_response["result"]["scriptId"].is_string()) {
+            // Syntax error or stale context: the evaluate response reports it the usual way.
+            forget_script();
+        } else {
+            std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+            auto context_iterator = session_state->script_ids_by_context.find(context_id);
+            if (context_iterator != session_state->script_ids_by_context.end()) {
+                CompiledScript &compiled = context_iterator->second[script_hash];
+                compiled.source = script;
+                compiled.script_id = compile_response["result"]["scriptId"].get<std::string>();
+            }
+        }
+        if (eval_response.contains("error") && eval_response["error"].is_object()) {
+            return json();  // context gone: evaluate again in the current one
+        }
+        return eval_response;
+    }
+
+    json run_params;
+    run_params["scriptId"] = script_id;
+    run_params["executionContextId"] = context_id;
+    run_params["returnByValue"] = true;
+    json run_response = send_command("Runtime.runScript", run_params, active_session_id(), timeout_milliseconds);
+    if (run_response.contains("error") && run_response["error"].is_object()) {
+        // Rejected by the protocol (the script did not run): drop the entry and evaluate.
+        forget_script();
+        return json();
+    }
+    return run_response;
+}
+
 browser_driver::EvaluateJavaScriptResult evaluate_javascript(const std::string &script,
                                                             int timeout_milliseconds) {
     browser_driver::EvaluateJavaScriptResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
     }
 
-    json eval_params;
-    eval_params["expression"] = script;
-    eval_params["returnByValue"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
-    }
+    json eval_response = run_compiled_script(script, timeout_milliseconds);
+    if (eval_response.is_null()) {
+        json eval_params;
+        eval_params["expression"] = script;
+        eval_params["returnByValue"] = true;
+        apply_frame_context(eval_params);
 
-    json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, timeout_milliseconds);
+        eval_response = send_command("Runtime.evaluate", eval_params,
+                                     active_session_id(), timeout_milliseconds);
+    }
 
     if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
         result.success = false;
@@ -1715,64 +3532,33 @@ browser_driver::EvaluateJavaScriptResult evaluate_javascript(const std::string &
     return result;
 }
 
-// --- hover_element (mouse move to element center) ---
-
-browser_driver::DriverResult hover_element(const std::string &selector) {
-    browser_driver::DriverResult result;
-
-    if (!global_state.connected || global_state.current_session_id.empty()) {
-        result.success = false;
-        result.error_detail = "No active browser session. Call open_browser first.";
-        result.message = "hover_element failed.";
-        return result;
-    }
+// --- hover_element (mouse move to element center) ---
 
-    ensure_dom_enabled();
+browser_driver::DriverResult hover_element(const std::string &selector, int timeout_milliseconds) {
+    browser_driver::DriverResult result;
 
-    json get_doc_response = send_command("DOM.getDocument", json::object(),
-                                         global_state.current_session_id);
-    if (!get_doc_response.contains("result") || !get_doc_response["result"].contains("root")) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
-        result.error_detail = "DOM.getDocument failed.";
+        result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "hover_element failed.";
         return result;
     }
-    int root_node_id = get_doc_response["result"]["root"]["nodeId"].get<int>();
 
-    json query_params;
-    query_params["nodeId"] = root_node_id;
-    query_params["selector"] = selector;
-    json query_response = send_command("DOM.querySelector", query_params,
-                                       global_state.current_session_id);
-    if (!query_response.contains("result") || query_response["result"]["nodeId"].get<int>() == 0) {
+    ElementPoint point = resolve_element_point(selector, false, pointer_checks(), timeout_milliseconds);
+    if (!point.found || !point.not_actionable.empty()) {
         result.success = false;
-        result.error_detail = "Element not found: " + selector;
+        result.error_detail = element_point_error(selector, point, timeout_milliseconds);
         result.message = "hover_element failed.";
         return result;
     }
-
-    int node_id = query_response["result"]["nodeId"].get<int>();
-    json box_params;
-    box_params["nodeId"] = node_id;
-    json box_response = send_command("DOM.getBoxModel", box_params,
-                                     global_state.current_session_id);
-    if (!box_response.contains("result") || !box_response["result"].contains("model") ||
-        !box_response["result"]["model"].contains("content")) {
+    if (!point.hittable && !point.has_box) {
         result.success = false;
         result.error_detail = "No box model for element: " + selector;
         result.message = "hover_element failed.";
         return result;
     }
 
-    const auto &content = box_response["result"]["model"]["content"];
-    int x = static_cast<int>((content[0].get<double>() + content[4].get<double>()) / 2);
-    int y = static_cast<int>((content[1].get<double>() + content[5].get<double>()) / 2);
-
-    json mouse_move;
-    mouse_move["type"] = "mouseMoved";
-    mouse_move["x"] = x;
-    mouse_move["y"] = y;
-    send_command("Input.dispatchMouseEvent", mouse_move, global_state.current_session_id);
+    dispatch_mouse_events({make_mouse_event("mouseMoved", point.x, point.y)});
 
     result.success = true;
     result.message = "Hovered.";
@@ -1783,189 +3569,100 @@ browser_driver::DriverResult hover_element(const std::string &selector) {
 
 static browser_driver::DriverResult click_element_with_options(const std::string &selector,
                                                                const std::string &button,
-                                                               int click_count) {
+                                                               int click_count, int timeout_milliseconds) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "click failed.";
         return result;
     }
 
-    ensure_dom_enabled();
-
-    json get_doc_response = send_command("DOM.getDocument", json::object(),
-                                         global_state.current_session_id);
-    if (!get_doc_response.contains("result") || !get_doc_response["result"].contains("root")) {
+    // One page call scrolls into view, hit-tests and returns the center (or clicks in-page if covered).
+    ElementPoint point = resolve_element_point(selector, true, click_checks(), timeout_milliseconds);
+    if (!point.found || !point.not_actionable.empty()) {
         result.success = false;
-        result.error_detail = "DOM.getDocument failed.";
+        result.error_detail = element_point_error(selector, point, timeout_milliseconds);
         return result;
     }
-    int root_node_id = get_doc_response["result"]["root"]["nodeId"].get<int>();
-
-    json query_params;
-    query_params["nodeId"] = root_node_id;
-    query_params["selector"] = selector;
-    json query_response = send_command("DOM.querySelector", query_params,
-                                       global_state.current_session_id);
-    if (!query_response.contains("result") || query_response["result"]["nodeId"].get<int>() == 0) {
-        std::string click_script = "var el=document.querySelector(" + json(selector).dump() + ");"
-            "if(!el)throw new Error('Not found'); el.click();";
-        json eval_params;
-        eval_params["expression"] = click_script;
-        json eval_response = send_command("Runtime.evaluate", eval_params,
-                                          global_state.current_session_id, 5000);
-        if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
-            result.success = false;
-            result.error_detail = "Element not found: " + selector;
-            return result;
-        }
+    if (point.clicked_in_page) {
         result.success = true;
         result.message = "Clicked (fallback).";
         return result;
     }
 
-    int node_id = query_response["result"]["nodeId"].get<int>();
-    json box_params;
-    box_params["nodeId"] = node_id;
-    json box_response = send_command("DOM.getBoxModel", box_params,
-                                     global_state.current_session_id);
-    if (!box_response.contains("result") || !box_response["result"].contains("model") ||
-        !box_response["result"]["model"].contains("content")) {
-        std::string click_script = "var el=document.querySelector(" + json(selector).dump() + ");"
-            "if(!el)throw new Error('Not found'); el.click();";
-        json eval_params;
-        eval_params["expression"] = click_script;
-        json eval_response = send_command("Runtime.evaluate", eval_params,
-                                          global_state.current_session_id, 5000);
-        if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
-            result.success = false;
-            result.error_detail = "Element not found or no box model: " + selector;
-            return result;
-        }
-        result.success = true;
-        result.message = "Clicked (fallback).";
-        return result;
+    // Events for each click of a double click, sent back to back.
+    std::vector<json> mouse_events;
+    mouse_events.push_back(make_mouse_event("mouseMoved", point.x, point.y));
+    for (int click = 1; click <= click_count; click++) {
+        mouse_events.push_back(make_mouse_event("mousePressed", point.x, point.y, button, click));
+        mouse_events.push_back(make_mouse_event("mouseReleased", point.x, point.y, button, click));
     }
-
-    const auto &content = box_response["result"]["model"]["content"];
-    double left = content[0].get<double>();
-    double top = content[1].get<double>();
-    double right = content[4].get<double>();
-    double bottom = content[5].get<double>();
-    int x = static_cast<int>((left + right) / 2);
-    int y = static_cast<int>((top + bottom) / 2);
-
-    json mouse_press;
-    mouse_press["type"] = "mousePressed";
-    mouse_press["x"] = x;
-    mouse_press["y"] = y;
-    mouse_press["button"] = button;
-    mouse_press["clickCount"] = click_count;
-    json mouse_release;
-    mouse_release["type"] = "mouseReleased";
-    mouse_release["x"] = x;
-    mouse_release["y"] = y;
-    mouse_release["button"] = button;
-    mouse_release["clickCount"] = click_count;
-
-    send_command("Input.dispatchMouseEvent", mouse_press, global_state.current_session_id);
-    send_command("Input.dispatchMouseEvent", mouse_release, global_state.current_session_id);
+    dispatch_mouse_events(mouse_events);
 
     result.success = true;
     result.message = "Clicked.";
     return result;
 }
 
-browser_driver::DriverResult double_click_element(const std::string &selector) {
-    browser_driver::DriverResult r = click_element_with_options(selector, "left", 2);
+browser_driver::DriverResult double_click_element(const std::string &selector, int timeout_milliseconds) {
+    browser_driver::DriverResult r = click_element_with_options(selector, "left", 2, timeout_milliseconds);
     if (r.success) {
         r.message = "Double-clicked.";
     }
     return r;
 }
 
-browser_driver::DriverResult right_click_element(const std::string &selector) {
-    return click_element_with_options(selector, "right", 1);
+browser_driver::DriverResult right_click_element(const std::string &selector, int timeout_milliseconds) {
+    return click_element_with_options(selector, "right", 1, timeout_milliseconds);
 }
 
 // --- drag_and_drop_selectors, drag_from_to_coordinates ---
 
-static bool get_element_center(const std::string &selector, int &out_x, int &out_y) {
-    json get_doc = send_command("DOM.getDocument", json::object(),
-                                global_state.current_session_id);
-    if (!get_doc.contains("result") || !get_doc["result"].contains("root")) {
-        return false;
-    }
-    int root_id = get_doc["result"]["root"]["nodeId"].get<int>();
-    json qp;
-    qp["nodeId"] = root_id;
-    qp["selector"] = selector;
-    json qr = send_command("DOM.querySelector", qp, global_state.current_session_id);
-    if (!qr.contains("result") || qr["result"]["nodeId"].get<int>() == 0) {
-        return false;
-    }
-    json bp;
-    bp["nodeId"] = qr["result"]["nodeId"].get<int>();
-    json br = send_command("DOM.getBoxModel", bp, global_state.current_session_id);
-    if (!br.contains("result") || !br["result"].contains("model") ||
-        !br["result"]["model"].contains("content")) {
+static bool get_element_center(const std::string &selector, int timeout_milliseconds, int &out_x, int &out_y,
+                               std::string &out_error) {
+    ElementPoint point = resolve_element_point(selector, false, pointer_checks(), timeout_milliseconds);
+    if (!point.found || !point.not_actionable.empty() || (!point.hittable && !point.has_box)) {
+        out_error = element_point_error(selector, point, timeout_milliseconds);
         return false;
     }
-    const auto &content = br["result"]["model"]["content"];
-    out_x = static_cast<int>((content[0].get<double>() + content[4].get<double>()) / 2);
-    out_y = static_cast<int>((content[1].get<double>() + content[5].get<double>()) / 2);
+    out_x = point.x;
+    out_y = point.y;
     return true;
 }
 
 browser_driver::DriverResult drag_and_drop_selectors(const std::string &source_selector,
-                                                      const std::string &target_selector) {
+                                                      const std::string &target_selector,
+                                                      int timeout_milliseconds) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "drag_and_drop failed.";
         return result;
     }
 
-    ensure_dom_enabled();
-
     int x1 = 0, y1 = 0, x2 = 0, y2 = 0;
-    if (!get_element_center(source_selector, x1, y1)) {
+    std::string point_error;
+    if (!get_element_center(source_selector, timeout_milliseconds, x1, y1, point_error)) {
         result.success = false;
-        result.error_detail = "Source element not found: " + source_selector;
+        result.error_detail = "Source: " + point_error;
         result.message = "drag_and_drop failed.";
         return result;
     }
-    if (!get_element_center(target_selector, x2, y2)) {
+    if (!get_element_center(target_selector, timeout_milliseconds, x2, y2, point_error)) {
         result.success = false;
-        result.error_detail = "Target element not found: " + target_selector;
+        result.error_detail = "Target: " + point_error;
         result.message = "drag_and_drop failed.";
         return result;
     }
 
-    json press;
-    press["type"] = "mousePressed";
-    press["x"] = x1;
-    press["y"] = y1;
-    press["button"] = "left";
-    press["clickCount"] = 1;
-    json move;
-    move["type"] = "mouseMoved";
-    move["x"] = x2;
-    move["y"] = y2;
-    json release;
-    release["type"] = "mouseReleased";
-    release["x"] = x2;
-    release["y"] = y2;
-    release["button"] = "left";
-    release["clickCount"] = 1;
-
-    send_command("Input.dispatchMouseEvent", press, global_state.current_session_id);
-    send_command("Input.dispatchMouseEvent", move, global_state.current_session_id);
-    send_command("Input.dispatchMouseEvent", release, global_state.current_session_id);
+    dispatch_mouse_events({make_mouse_event("mouseMoved", x1, y1),
+                           make_mouse_event("mousePressed", x1, y1, "left", 1),
+                           make_mouse_event("mouseMoved", x2, y2),
+                           make_mouse_event("mouseReleased", x2, y2, "left", 1)});
 
     result.success = true;
     result.message = "Drag and drop done.";
@@ -1975,7 +3672,7 @@ browser_driver::DriverResult drag_and_drop_selectors(const std::string &source_s
 browser_driver::DriverResult drag_from_to_coordinates(int x1, int y1, int x2, int y2) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "drag_from_to failed.";
@@ -1999,9 +3696,9 @@ browser_driver::DriverResult drag_from_to_coordinates(int x1, int y1, int x2, in
     release["button"] = "left";
     release["clickCount"] = 1;
 
-    send_command("Input.dispatchMouseEvent", press, global_state.current_session_id);
-    send_command("Input.dispatchMouseEvent", move, global_state.current_session_id);
-    send_command("Input.dispatchMouseEvent", release, global_state.current_session_id);
+    send_command("Input.dispatchMouseEvent", press, active_session_id());
+    send_command("Input.dispatchMouseEvent", move, active_session_id());
+    send_command("Input.dispatchMouseEvent", release, active_session_id());
 
     result.success = true;
     result.message = "Drag from to done.";
@@ -2013,7 +3710,7 @@ browser_driver::DriverResult drag_from_to_coordinates(int x1, int y1, int x2, in
 browser_driver::GetPageSourceResult get_page_source() {
     browser_driver::GetPageSourceResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
@@ -2022,11 +3719,9 @@ browser_driver::GetPageSourceResult get_page_source() {
     json eval_params;
     eval_params["expression"] = "document.documentElement.outerHTML";
     eval_params["returnByValue"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
-    }
+    apply_frame_context(eval_params);
     json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 5000);
+                                      active_session_id(), 5000);
 
     if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
         result.success = false;
@@ -2049,25 +3744,21 @@ browser_driver::GetPageSourceResult get_page_source() {
 browser_driver::GetPageSourceResult get_outer_html(const std::string &selector) {
     browser_driver::GetPageSourceResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
     }
 
-    std::string escaped_selector = json(selector).dump();
-    std::string script = "var el=document.querySelector(" + escaped_selector + ");"
-        "el ? el.outerHTML : '';";
-    json eval_params;
-    eval_params["expression"] = script;
-    eval_params["returnByValue"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
+    std::string object_id;
+    if (is_element_handle(selector) && !resolve_element_handle(selector, object_id, result.error_detail)) {
+        result.success = false;
+        return result;
     }
-    json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 5000);
+    json eval_response = call_page_runtime("outerHtml", json::array({selector}), 5000, object_id);
 
-    if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
+    if (eval_response.contains("error") ||
+        (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails"))) {
         result.success = false;
         result.error_detail = "Element not found or failed: " + selector;
         return result;
@@ -2085,12 +3776,161 @@ browser_driver::GetPageSourceResult get_outer_html(const std::string &selector)
     return result;
 }
 
+browser_driver::GetPageTextResult get_page_text(const std::string &selector, int cursor, int max_bytes) {
+    browser_driver::GetPageTextResult result;
+
+    if (!active_browser->connected || active_session_id().empty()) {
+        result.success = false;
+        result.error_detail = "No active browser session. Call open_browser first.";
+        return result;
+    }
+
+    std::string object_id;
+    if (is_element_handle(selector) && !resolve_element_handle(selector, object_id, result.error_detail)) {
+        result.success = false;
+        return result;
+    }
+    json response = call_page_runtime("pageText", json::array({selector, cursor, max_bytes}), 15000, object_id);
+    if (response.contains("error") && response["error"].is_string()) {
+        result.success = false;
+        result.error_detail = response["error"].get<std::string>();
+        return result;
+    }
+    if (!response.contains("result") || !response["result"].contains("result") ||
+        response["result"].contains("exceptionDetails")) {
+        result.success = false;
+        result.error_detail = object_id.empty() ? "Text extraction failed: " + response.dump()
+                                                : "Stale element handle '" + selector + "'.";
+        return result;
+    }
+    const json &value = response["result"]["result"].value("value", json::object());
+    if (!value.is_object() || !value.value("found", false)) {
+        result.success = false;
+        result.error_detail = "Element not found: " + selector;
+        return result;
+    }
+    result.text = value.value("text", "");
+    utf8_sanitize::sanitize(result.text);
+    result.next_cursor = value.value("next", -1);
+    result.total_length = value.value("total", 0);
+    result.success = true;
+    return result;
+}
+
+// --- Accessibility tree outline ---
+
+// backendNodeId of a selector or element handle, for subtree-scoped queries.
+static int backend_node_id_for_selector(const std::string &selector, std::string &out_error) {
+    if (is_element_handle(selector) && selector.size() > 2 && selector[1] == 'n') {
+        try {
+            return std::stoi(selector.substr(2));
+        } catch (...) {
+            out_error = "Invalid element handle '" + selector + "'.";
+            return 0;
+        }
+    }
+
+    json describe_params;
+    if (is_element_handle(selector) || is_engine_selector(selector)) {
+        std::string object_id;
+        if (!resolve_selector_object(selector, object_id, out_error)) {
+            return 0;
+        }
+        describe_params["objectId"] = object_id;
+    } else {
+        ensure_dom_enabled();
+        int node_id = query_selector_node_id(selector);
+        if (node_id == 0) {
+            out_error = "Element not found: " + selector;
+            return 0;
+        }
+        describe_params["nodeId"] = node_id;
+    }
+    json describe_response = send_command("DOM.describeNode", describe_params, active_session_id(), 5000);
+    if (!describe_response.contains("result") || !describe_response["result"].contains("node") ||
+        !describe_response["result"]["node"].contains("backendNodeId")) {
+        out_error = "DOM.describeNode failed for " + selector + ": " + describe_response.dump();
+        return 0;
+    }
+    return describe_response["result"]["node"]["backendNodeId"].get<int>();
+}
+
+browser_driver::GetAccessibilityTreeResult get_accessibility_tree(const std::string &selector, bool viewport_only,
+                                                                  int max_lines) {
+    browser_driver::GetAccessibilityTreeResult result;
+
+    if (!active_browser->connected || active_session_id().empty()) {
+        result.success = false;
+        result.error_detail = "No active browser session. Call open_browser first.";
+        return result;
+    }
+
+    cdp_ax_outline::AxOutlineOptions options;
+    options.max_lines = max_lines > 0 ? max_lines : options.max_lines;
+    if (!selector.empty()) {
+        options.root_backend_node_id = backend_node_id_for_selector(selector, result.error_detail);
+        if (options.root_backend_node_id == 0) {
+            result.success = false;
+            return result;
+        }
+    }
+
+    // Tree, layout snapshot and viewport size are requested together: one round trip.
+    int tree_id = send_command_async("Accessibility.getFullAXTree", json::object(), active_session_id());
+    int snapshot_id = -1;
+    int metrics_id = -1;
+    if (viewport_only) {
+        json snapshot_params;
+        snapshot_params["computedStyles"] = cdp_dom_snapshot::required_computed_styles();
+        snapshot_id = send_command_async("DOMSnapshot.captureSnapshot", snapshot_params, active_session_id());
+        metrics_id = send_command_async("Page.getLayoutMetrics", json::object(), active_session_id());
+    }
+    json tree_response = wait_for_response(tree_id, "Accessibility.getFullAXTree", 15000);
+
+    std::unordered_set<int> visible_backend_node_ids;
+    if (viewport_only) {
+        json snapshot_response = wait_for_response(snapshot_id, "DOMSnapshot.captureSnapshot", 15000);
+        json metrics_response = wait_for_response(metrics_id, "Page.getLayoutMetrics", 5000);
+        if (!snapshot_response.contains("result") || !metrics_response.contains("result") ||
+            !metrics_response["result"].contains("cssLayoutViewport")) {
+            result.success = false;
+            result.error_detail = "Could not determine the viewport contents: " + snapshot_response.dump();
+            return result;
+        }
+        const json &layout_viewport = metrics_response["result"]["cssLayoutViewport"];
+        visible_backend_node_ids = cdp_dom_snapshot::backend_node_ids_in_viewport(
+            snapshot_response["result"], layout_viewport.value("clientWidth", 0.0),
+            layout_viewport.value("clientHeight", 0.0));
+        options.visible_backend_node_ids = &visible_backend_node_ids;
+    }
+
+    if (!tree_response.contains("result") || !tree_response["result"].contains("nodes")) {
+        result.success = false;
+        result.error_detail = "Accessibility.getFullAXTree failed: " + tree_response.dump();
+        return result;
+    }
+
+    cdp_ax_outline::AxOutline outline = cdp_ax_outline::format_ax_outline(tree_response["result"]["nodes"], options);
+    if (!outline.root_found) {
+        result.success = false;
+        result.error_detail = selector.empty() ? "The accessibility tree is empty."
+                                               : "The element has no accessibility node: " + selector;
+        return result;
+    }
+    result.outline = outline.text;
+    utf8_sanitize::sanitize(result.outline);
+    result.line_count = outline.line_count;
+    result.truncated = outline.truncated;
+    result.success = true;
+    return result;
+}
+
 // --- send_keys, key_press, key_down, key_up ---
 
 browser_driver::DriverResult send_keys(const std::string &keys, const std::string &selector) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "send_keys failed.";
@@ -2098,14 +3938,15 @@ browser_driver::DriverResult send_keys(const std::string &keys, const std::strin
     }
 
     if (!selector.empty()) {
-        std::string escaped_selector = json(selector).dump();
-        std::string focus_script = "var el=document.querySelector(" + escaped_selector + ");"
-            "if(!el){ throw new Error('Element not found'); } el.focus();";
-        json eval_params;
-        eval_params["expression"] = focus_script;
-        json focus_response = send_command("Runtime.evaluate", eval_params,
-                                           global_state.current_session_id, 5000);
-        if (focus_response.contains("result") && focus_response["result"].contains("exceptionDetails")) {
+        std::string object_id;
+        if (is_element_handle(selector) && !resolve_element_handle(selector, object_id, result.error_detail)) {
+            result.success = false;
+            result.message = "send_keys failed.";
+            return result;
+        }
+        json focus_response = call_page_runtime("focusField", json::array({selector, false}), 5000, object_id);
+        if (focus_response.contains("error") ||
+            (focus_response.contains("result") && focus_response["result"].contains("exceptionDetails"))) {
             result.success = false;
             result.error_detail = "Element not found: " + selector;
             result.message = "send_keys failed.";
@@ -2123,15 +3964,15 @@ browser_driver::DriverResult send_keys(const std::string &keys, const std::strin
                 if (!literal_text.empty()) {
                     json insert_params;
                     insert_params["text"] = literal_text;
-                    send_command("Input.insertText", insert_params, global_state.current_session_id);
+                    send_command("Input.insertText", insert_params, active_session_id());
                     literal_text.clear();
                 }
                 json key_params;
                 key_params["key"] = key_name;
                 key_params["type"] = "keyDown";
-                send_command("Input.dispatchKeyEvent", key_params, global_state.current_session_id);
+                send_command("Input.dispatchKeyEvent", key_params, active_session_id());
                 key_params["type"] = "keyUp";
-                send_command("Input.dispatchKeyEvent", key_params, global_state.current_session_id);
+                send_command("Input.dispatchKeyEvent", key_params, active_session_id());
                 i = close + 1;
                 continue;
             }
@@ -2143,7 +3984,7 @@ browser_driver::DriverResult send_keys(const std::string &keys, const std::strin
         json insert_params;
         insert_params["text"] = literal_text;
         json insert_response = send_command("Input.insertText", insert_params,
-                                            global_state.current_session_id, 5000);
+                                            active_session_id(), 5000);
         if (insert_response.contains("error") && insert_response["error"].is_string()) {
             result.success = false;
             result.error_detail = insert_response["error"].get<std::string>();
@@ -2160,7 +4001,7 @@ browser_driver::DriverResult send_keys(const std::string &keys, const std::strin
 browser_driver::DriverResult key_press(const std::string &key) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "key_press failed.";
@@ -2170,11 +4011,11 @@ browser_driver::DriverResult key_press(const std::string &key) {
     json key_down_params;
     key_down_params["key"] = key;
     key_down_params["type"] = "keyDown";
-    send_command("Input.dispatchKeyEvent", key_down_params, global_state.current_session_id);
+    send_command("Input.dispatchKeyEvent", key_down_params, active_session_id());
     json key_up_params;
     key_up_params["key"] = key;
     key_up_params["type"] = "keyUp";
-    send_command("Input.dispatchKeyEvent", key_up_params, global_state.current_session_id);
+    send_command("Input.dispatchKeyEvent", key_up_params, active_session_id());
 
     result.success = true;
     result.message = "Key pressed.";
@@ -2184,7 +4025,7 @@ browser_driver::DriverResult key_press(const std::string &key) {
 browser_driver::DriverResult key_down(const std::string &key) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "key_down failed.";
@@ -2194,7 +4035,7 @@ browser_driver::DriverResult key_down(const std::string &key) {
     json key_params;
     key_params["key"] = key;
     key_params["type"] = "keyDown";
-    send_command("Input.dispatchKeyEvent", key_params, global_state.current_session_id);
+    send_command("Input.dispatchKeyEvent", key_params, active_session_id());
 
     result.success = true;
     result.message = "Key down.";
@@ -2204,7 +4045,7 @@ browser_driver::DriverResult key_down(const std::string &key) {
 browser_driver::DriverResult key_up(const std::string &key) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "key_up failed.";
@@ -2214,7 +4055,7 @@ browser_driver::DriverResult key_up(const std::string &key) {
     json key_params;
     key_params["key"] = key;
     key_params["type"] = "keyUp";
-    send_command("Input.dispatchKeyEvent", key_params, global_state.current_session_id);
+    send_command("Input.dispatchKeyEvent", key_params, active_session_id());
 
     result.success = true;
     result.message = "Key up.";
@@ -2238,92 +4079,148 @@ browser_driver::DriverResult wait_seconds(double seconds) {
     return result;
 }
 
-browser_driver::DriverResult wait_for_selector(const std::string &selector, int timeout_milliseconds) {
+static bool is_wait_state(const std::string &state) {
+    return state == "attached" || state == "detached" || state == "visible" || state == "hidden" ||
+           state == "enabled";
+}
+
+// wait_for_selector: pause before waiting again in a document that replaced a destroyed one.
+static constexpr int kWaitForSelectorRetryPauseMs = 50;
+
+browser_driver::DriverResult wait_for_selector(const std::string &selector, int timeout_milliseconds,
+                                               const std::string &state) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "wait_for_selector failed.";
         return result;
     }
+    if (!is_wait_state(state)) {
+        result.success = false;
+        result.error_detail = "state must be attached, detached, visible, hidden or enabled.";
+        result.message = "wait_for_selector failed.";
+        return result;
+    }
 
-    std::string escaped_selector = json(selector).dump();
-    std::string script = "document.querySelector(" + escaped_selector + ") ? true : false;";
-    json eval_params;
-    eval_params["expression"] = script;
-    eval_params["returnByValue"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
+    std::string object_id;
+    if (is_element_handle(selector) && !resolve_element_handle(selector, object_id, result.error_detail)) {
+        if (state == "detached" || state == "hidden") {
+            result.success = true;
+            result.message = "Element " + state + ".";
+            return result;
+        }
+        result.success = false;
+        result.message = "wait_for_selector failed.";
+        return result;
     }
 
+    // A navigation destroys the waiting context: wait again in the new document for the time left.
     auto start = std::chrono::steady_clock::now();
-    int elapsed = 0;
-    while (elapsed < timeout_milliseconds) {
-        json eval_response = send_command("Runtime.evaluate", eval_params,
-                                          global_state.current_session_id, 2000);
-        if (eval_response.contains("result") && eval_response["result"].contains("result")) {
-            const json &res = eval_response["result"]["result"];
-            if (res.contains("value") && res["value"].is_boolean() && res["value"].get<bool>()) {
+    int remaining = timeout_milliseconds;
+    while (remaining > 0) {
+        json response = call_page_runtime("waitForSelector", json::array({selector, state, remaining}),
+                                          remaining + 2000, object_id);
+        int elapsed = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        remaining = timeout_milliseconds - elapsed;
+
+        if (response.contains("result") && response["result"].contains("result") &&
+            !response["result"].contains("exceptionDetails")) {
+            const json &value = response["result"]["result"].value("value", json::object());
+            if (value.is_object() && value.value("ok", false)) {
                 result.success = true;
-                result.message = "Selector found.";
+                result.message = "Selector " + state + " after " + std::to_string(elapsed) + " ms.";
                 return result;
             }
+            if (value.is_object()) {
+                break;  // timed out in the page
+            }
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        elapsed = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - start).count());
+        if (response.contains("result") || !is_context_lost_response(response)) {
+            result.success = false;
+            if (response.contains("result") && response["result"].contains("exceptionDetails")) {
+                result.error_detail = "Invalid selector or page error: " +
+                                      response["result"]["exceptionDetails"].value("text", std::string("exception"));
+            } else if (response.contains("error")) {
+                result.error_detail = response["error"].is_string() ? response["error"].get<std::string>()
+                                                                    : response["error"].dump();
+            } else {
+                result.error_detail = "Unexpected waitForSelector result: " + response.dump();
+            }
+            result.message = "wait_for_selector failed.";
+            return result;
+        }
+        if (!object_id.empty()) {
+            // The handle's element went away with its document.
+            if (state == "detached" || state == "hidden") {
+                result.success = true;
+                result.message = "Element " + state + ".";
+                return result;
+            }
+            break;
+        }
+        service_websocket(kWaitForSelectorRetryPauseMs);
     }
 
     result.success = false;
-    result.error_detail = "Timeout waiting for selector: " + selector;
+    result.error_detail = "Timeout waiting for selector to be " + state + ": " + selector;
     result.message = "wait_for_selector failed.";
     return result;
 }
 
-browser_driver::DriverResult wait_for_navigation(int timeout_milliseconds) {
+browser_driver::DriverResult wait_for_navigation(int timeout_milliseconds, const std::string &wait_until) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "wait_for_navigation failed.";
         return result;
     }
+    std::string milestone = lifecycle_milestone(wait_until);
+    if (milestone.empty()) {
+        result.success = false;
+        result.error_detail = "wait_until must be commit, DOMContentLoaded, load, networkIdle or firstMeaningfulPaint.";
+        result.message = "wait_for_navigation failed.";
+        return result;
+    }
 
-    std::string script = "document.readyState";
-    json eval_params;
-    eval_params["expression"] = script;
-    eval_params["returnByValue"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
+    // The main frame's id is the page's targetId. Its current document (whatever loader is
+    // current when the milestone arrives) is waited for through lifecycle events.
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    std::string frame_id = session_state->target_id.empty() ? active_target_id() : session_state->target_id;
+    bool known = false;
+    {
+        std::lock_guard<std::mutex> lock(session_state->lifecycle_mutex);
+        known = session_state->lifecycle_by_frame_id.count(frame_id) > 0;
+    }
+    if (!known && milestone == "load") {
+        // Document loaded before lifecycle events were enabled: ask once.
+        json eval_params;
+        eval_params["expression"] = "document.readyState";
+        eval_params["returnByValue"] = true;
+        json eval_response = send_command("Runtime.evaluate", eval_params, active_session_id(), 2000);
+        if (eval_response.contains("result") && eval_response["result"].contains("result") &&
+            eval_response["result"]["result"].value("value", "") == "complete") {
+            result.success = true;
+            result.message = "Navigation complete (load).";
+            return result;
+        }
     }
 
     auto start = std::chrono::steady_clock::now();
-    int elapsed = 0;
-    std::string last_ready_state;
-    while (elapsed < timeout_milliseconds) {
-        json eval_response = send_command("Runtime.evaluate", eval_params,
-                                          global_state.current_session_id, 2000);
-        if (eval_response.contains("result") && eval_response["result"].contains("result")) {
-            const json &res = eval_response["result"]["result"];
-            if (res.contains("value") && res["value"].is_string()) {
-                std::string ready_state = res["value"].get<std::string>();
-                if (ready_state == "complete") {
-                    result.success = true;
-                    result.message = "Navigation complete.";
-                    return result;
-                }
-                last_ready_state = ready_state;
-            }
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        elapsed = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+    if (wait_for_lifecycle_milestone(*session_state, frame_id, "", milestone, timeout_milliseconds)) {
+        int elapsed = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::steady_clock::now() - start).count());
+        result.success = true;
+        result.message = "Navigation complete (" + milestone + " after " + std::to_string(elapsed) + " ms).";
+        return result;
     }
 
     result.success = false;
-    result.error_detail = "Timeout waiting for navigation (last readyState: " + last_ready_state + ").";
+    result.error_detail = "Timeout waiting for " + milestone + ".";
     result.message = "wait_for_navigation failed.";
     return result;
 }
@@ -2333,7 +4230,7 @@ browser_driver::DriverResult wait_for_navigation(int timeout_milliseconds) {
 browser_driver::GetCookiesResult get_cookies(const std::string &url) {
     browser_driver::GetCookiesResult result;
 
-    if (!global_state.connected) {
+    if (!active_browser->connected) {
         result.success = false;
         result.error_detail = "No active browser. Call open_browser first.";
         return result;
@@ -2382,7 +4279,7 @@ browser_driver::DriverResult set_cookie(const std::string &name, const std::stri
                                          const std::string &path) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected) {
+    if (!active_browser->connected) {
         result.success = false;
         result.error_detail = "No active browser. Call open_browser first.";
         result.message = "set_cookie failed.";
@@ -2423,7 +4320,7 @@ browser_driver::DriverResult set_cookie(const std::string &name, const std::stri
 browser_driver::DriverResult clear_cookies() {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected) {
+    if (!active_browser->connected) {
         result.success = false;
         result.error_detail = "No active browser. Call open_browser first.";
         result.message = "clear_cookies failed.";
@@ -2447,16 +4344,17 @@ browser_driver::DriverResult clear_cookies() {
 browser_driver::GetDialogMessageResult get_dialog_message() {
     browser_driver::GetDialogMessageResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session.";
         return result;
     }
 
-    std::lock_guard<std::mutex> lock(global_state.dialog_mutex);
-    result.dialog_open = !global_state.last_dialog_message.empty() || !global_state.last_dialog_type.empty();
-    result.message = global_state.last_dialog_message;
-    result.type = global_state.last_dialog_type;
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    std::lock_guard<std::mutex> lock(session_state->dialog_mutex);
+    result.dialog_open = !session_state->last_dialog_message.empty() || !session_state->last_dialog_type.empty();
+    result.message = session_state->last_dialog_message;
+    result.type = session_state->last_dialog_type;
     result.success = true;
     return result;
 }
@@ -2464,7 +4362,7 @@ browser_driver::GetDialogMessageResult get_dialog_message() {
 browser_driver::DriverResult accept_dialog() {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "accept_dialog failed.";
@@ -2474,7 +4372,7 @@ browser_driver::DriverResult accept_dialog() {
     json params;
     params["accept"] = true;
     json response = send_command("Page.handleJavaScriptDialog", params,
-                                 global_state.current_session_id, 5000);
+                                 active_session_id(), 5000);
     if (response.contains("error") && response["error"].is_string()) {
         result.success = false;
         result.error_detail = response["error"].get<std::string>();
@@ -2482,9 +4380,10 @@ browser_driver::DriverResult accept_dialog() {
         return result;
     }
     {
-        std::lock_guard<std::mutex> lock(global_state.dialog_mutex);
-        global_state.last_dialog_message.clear();
-        global_state.last_dialog_type.clear();
+        std::shared_ptr<SessionState> session_state = current_session_state();
+        std::lock_guard<std::mutex> lock(session_state->dialog_mutex);
+        session_state->last_dialog_message.clear();
+        session_state->last_dialog_type.clear();
     }
     result.success = true;
     result.message = "Dialog accepted.";
@@ -2494,7 +4393,7 @@ browser_driver::DriverResult accept_dialog() {
 browser_driver::DriverResult dismiss_dialog() {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "dismiss_dialog failed.";
@@ -2504,7 +4403,7 @@ browser_driver::DriverResult dismiss_dialog() {
     json params;
     params["accept"] = false;
     json response = send_command("Page.handleJavaScriptDialog", params,
-                                 global_state.current_session_id, 5000);
+                                 active_session_id(), 5000);
     if (response.contains("error") && response["error"].is_string()) {
         result.success = false;
         result.error_detail = response["error"].get<std::string>();
@@ -2512,9 +4411,10 @@ browser_driver::DriverResult dismiss_dialog() {
         return result;
     }
     {
-        std::lock_guard<std::mutex> lock(global_state.dialog_mutex);
-        global_state.last_dialog_message.clear();
-        global_state.last_dialog_type.clear();
+        std::shared_ptr<SessionState> session_state = current_session_state();
+        std::lock_guard<std::mutex> lock(session_state->dialog_mutex);
+        session_state->last_dialog_message.clear();
+        session_state->last_dialog_type.clear();
     }
     result.success = true;
     result.message = "Dialog dismissed.";
@@ -2524,7 +4424,7 @@ browser_driver::DriverResult dismiss_dialog() {
 browser_driver::DriverResult send_prompt_value(const std::string &text) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "send_prompt_value failed.";
@@ -2535,7 +4435,7 @@ browser_driver::DriverResult send_prompt_value(const std::string &text) {
     params["accept"] = true;
     params["promptText"] = text;
     json response = send_command("Page.handleJavaScriptDialog", params,
-                                 global_state.current_session_id, 5000);
+                                 active_session_id(), 5000);
     if (response.contains("error") && response["error"].is_string()) {
         result.success = false;
         result.error_detail = response["error"].get<std::string>();
@@ -2543,9 +4443,10 @@ browser_driver::DriverResult send_prompt_value(const std::string &text) {
         return result;
     }
     {
-        std::lock_guard<std::mutex> lock(global_state.dialog_mutex);
-        global_state.last_dialog_message.clear();
-        global_state.last_dialog_type.clear();
+        std::shared_ptr<SessionState> session_state = current_session_state();
+        std::lock_guard<std::mutex> lock(session_state->dialog_mutex);
+        session_state->last_dialog_message.clear();
+        session_state->last_dialog_type.clear();
     }
     result.success = true;
     result.message = "Prompt value sent.";
@@ -2557,7 +4458,7 @@ browser_driver::DriverResult send_prompt_value(const std::string &text) {
 browser_driver::DriverResult upload_file(const std::string &selector, const std::string &file_path) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "upload_file failed.";
@@ -2566,34 +4467,40 @@ browser_driver::DriverResult upload_file(const std::string &selector, const std:
 
     ensure_dom_enabled();
 
-    json get_doc_response = send_command("DOM.getDocument", json::object(),
-                                         global_state.current_session_id);
-    if (!get_doc_response.contains("result") || !get_doc_response["result"].contains("root")) {
-        result.success = false;
-        result.error_detail = "DOM.getDocument failed.";
-        result.message = "upload_file failed.";
+    json params;
+    params["files"] = json::array({file_path});
+    if (is_element_handle(selector) || is_engine_selector(selector)) {
+        std::string object_id;
+        if (!resolve_selector_object(selector, object_id, result.error_detail)) {
+            result.success = false;
+            result.message = "upload_file failed.";
+            return result;
+        }
+        params["objectId"] = object_id;
+        json set_response = send_command("DOM.setFileInputFiles", params, active_session_id(), 5000);
+        if (set_response.contains("error")) {
+            result.success = false;
+            result.error_detail = "DOM.setFileInputFiles failed (stale handle or not a file input): " +
+                                  set_response.dump();
+            result.message = "upload_file failed.";
+            return result;
+        }
+        result.success = true;
+        result.message = "File set.";
         return result;
     }
-    int root_node_id = get_doc_response["result"]["root"]["nodeId"].get<int>();
 
-    json query_params;
-    query_params["nodeId"] = root_node_id;
-    query_params["selector"] = selector;
-    json query_response = send_command("DOM.querySelector", query_params,
-                                       global_state.current_session_id);
-    if (!query_response.contains("result") || query_response["result"]["nodeId"].get<int>() == 0) {
+    int node_id = query_selector_node_id(selector);
+    if (node_id == 0) {
         result.success = false;
         result.error_detail = "File input element not found: " + selector;
         result.message = "upload_file failed.";
         return result;
     }
 
-    int node_id = query_response["result"]["nodeId"].get<int>();
-    json params;
     params["nodeId"] = node_id;
-    params["files"] = json::array({file_path});
     json set_response = send_command("DOM.setFileInputFiles", params,
-                                     global_state.current_session_id, 5000);
+                                     active_session_id(), 5000);
 
     if (set_response.contains("error") && set_response["error"].is_string()) {
         result.success = false;
@@ -2611,14 +4518,14 @@ browser_driver::DriverResult upload_file(const std::string &selector, const std:
 browser_driver::ListFramesResult list_frames() {
     browser_driver::ListFramesResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
     }
 
     json response = send_command("Page.getFrameTree", json::object(),
-                                 global_state.current_session_id, 5000);
+                                 active_session_id(), 5000);
     if (!response.contains("result") || !response["result"].contains("frameTree")) {
         result.success = false;
         result.error_detail = "Page.getFrameTree failed.";
@@ -2655,7 +4562,7 @@ browser_driver::ListFramesResult list_frames() {
 browser_driver::DriverResult switch_to_frame(const std::string &frame_id_or_index) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "switch_to_frame failed.";
@@ -2670,8 +4577,10 @@ browser_driver::DriverResult switch_to_frame(const std::string &frame_id_or_inde
         return result;
     }
 
+    std::shared_ptr<SessionState> session_state = current_session_state();
     if (frame_id_or_index.empty()) {
-        global_state.current_execution_context_id = 0;
+        std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+        session_state->current_execution_context_id = 0;
         result.success = true;
         result.message = "Switched to main frame.";
         return result;
@@ -2694,10 +4603,10 @@ browser_driver::DriverResult switch_to_frame(const std::string &frame_id_or_inde
         eval_params["contextId"] = 0;
         for (int attempt = 0; attempt < 50; attempt++) {
             service_websocket(100);
-            std::lock_guard<std::mutex> lock(global_state.frame_mutex);
-            auto it = global_state.execution_context_id_by_frame_id.find(frame_id);
-            if (it != global_state.execution_context_id_by_frame_id.end()) {
-                global_state.current_execution_context_id = it->second;
+            std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+            auto it = session_state->execution_context_id_by_frame_id.find(frame_id);
+            if (it != session_state->execution_context_id_by_frame_id.end()) {
+                session_state->current_execution_context_id = it->second;
                 result.success = true;
                 result.message = "Switched to frame.";
                 return result;
@@ -2709,10 +4618,10 @@ browser_driver::DriverResult switch_to_frame(const std::string &frame_id_or_inde
         return result;
     }
 
-    std::lock_guard<std::mutex> lock(global_state.frame_mutex);
-    auto it = global_state.execution_context_id_by_frame_id.find(frame_id_or_index);
-    if (it != global_state.execution_context_id_by_frame_id.end()) {
-        global_state.current_execution_context_id = it->second;
+    std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+    auto it = session_state->execution_context_id_by_frame_id.find(frame_id_or_index);
+    if (it != session_state->execution_context_id_by_frame_id.end()) {
+        session_state->current_execution_context_id = it->second;
         result.success = true;
         result.message = "Switched to frame.";
         return result;
@@ -2725,7 +4634,11 @@ browser_driver::DriverResult switch_to_frame(const std::string &frame_id_or_inde
 
 browser_driver::DriverResult switch_to_main_frame() {
     browser_driver::DriverResult result;
-    global_state.current_execution_context_id = 0;
+    {
+        std::shared_ptr<SessionState> session_state = current_session_state();
+        std::lock_guard<std::mutex> lock(session_state->frame_mutex);
+        session_state->current_execution_context_id = 0;
+    }
     result.success = true;
     result.message = "Switched to main frame.";
     return result;
@@ -2737,7 +4650,7 @@ browser_driver::GetPageSourceResult get_storage(const std::string &storage_type,
                                                 const std::string &key) {
     browser_driver::GetPageSourceResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
@@ -2753,11 +4666,9 @@ browser_driver::GetPageSourceResult get_storage(const std::string &storage_type,
     json eval_params;
     eval_params["expression"] = script;
     eval_params["returnByValue"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
-    }
+    apply_frame_context(eval_params);
     json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 5000);
+                                      active_session_id(), 5000);
 
     if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
         result.success = false;
@@ -2782,7 +4693,7 @@ browser_driver::DriverResult set_storage(const std::string &storage_type,
                                          const std::string &value) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "set_storage failed.";
@@ -2793,11 +4704,9 @@ browser_driver::DriverResult set_storage(const std::string &storage_type,
     std::string script = store + ".setItem(" + json(key).dump() + "," + json(value).dump() + ");";
     json eval_params;
     eval_params["expression"] = script;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
-    }
+    apply_frame_context(eval_params);
     json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 5000);
+                                      active_session_id(), 5000);
 
     if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
         result.success = false;
@@ -2815,7 +4724,7 @@ browser_driver::DriverResult set_storage(const std::string &storage_type,
 browser_driver::GetPageSourceResult get_clipboard() {
     browser_driver::GetPageSourceResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
@@ -2825,11 +4734,9 @@ browser_driver::GetPageSourceResult get_clipboard() {
     eval_params["expression"] = "navigator.clipboard.readText()";
     eval_params["awaitPromise"] = true;
     eval_params["returnByValue"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
-    }
+    apply_frame_context(eval_params);
     json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 5000);
+                                      active_session_id(), 5000);
 
     if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
         result.success = false;
@@ -2852,7 +4759,7 @@ browser_driver::GetPageSourceResult get_clipboard() {
 browser_driver::DriverResult set_clipboard(const std::string &text) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "set_clipboard failed.";
@@ -2863,11 +4770,9 @@ browser_driver::DriverResult set_clipboard(const std::string &text) {
     json eval_params;
     eval_params["expression"] = "navigator.clipboard.writeText(" + escaped + ")";
     eval_params["awaitPromise"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
-    }
+    apply_frame_context(eval_params);
     json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 5000);
+                                      active_session_id(), 5000);
 
     if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
         result.success = false;
@@ -2880,38 +4785,104 @@ browser_driver::DriverResult set_clipboard(const std::string &text) {
     return result;
 }
 
-// --- get_network_requests ---
+// --- get_network_requests, wait_for_network_idle ---
+
+// Requests already in flight when Network is enabled are never reported, so the idle window
+// restarts at enable time: the first wait_for_network_idle waits at least one full idle period.
+static void ensure_network_enabled(SessionState &session_state) {
+    if (!session_state.network_enabled) {
+        send_command("Network.enable", json::object(), active_session_id(), 5000);
+        session_state.network_enabled = true;
+        std::lock_guard<std::mutex> lock(session_state.network_mutex);
+        session_state.network_last_activity = std::chrono::steady_clock::now();
+    }
+}
 
 browser_driver::GetNetworkRequestsResult get_network_requests() {
     browser_driver::GetNetworkRequestsResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
     }
 
-    if (!global_state.network_enabled) {
-        send_command("Network.enable", json::object(), global_state.current_session_id, 5000);
-        global_state.network_enabled = true;
-    }
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    ensure_network_enabled(*session_state);
 
     for (int drain = 0; drain < 5; drain++) {
         service_websocket(20);
     }
 
-    std::lock_guard<std::mutex> lock(global_state.network_mutex);
-    result.requests = global_state.network_requests;
+    std::lock_guard<std::mutex> lock(session_state->network_mutex);
+    result.requests.assign(session_state->network_requests.begin(), session_state->network_requests.end());
     result.success = true;
     return result;
 }
 
+browser_driver::DriverResult wait_for_network_idle(int idle_milliseconds, int max_inflight, int timeout_milliseconds) {
+    browser_driver::DriverResult result;
+
+    if (!active_browser->connected || active_session_id().empty()) {
+        result.success = false;
+        result.error_detail = "No active browser session. Call open_browser first.";
+        result.message = "wait_for_network_idle failed.";
+        return result;
+    }
+
+    std::shared_ptr<SessionState> session_state = current_session_state();
+    ensure_network_enabled(*session_state);
+
+    // Idle = the in-flight count is within max_inflight and has not changed for idle_milliseconds.
+    auto start = std::chrono::steady_clock::now();
+    size_t inflight_count = 0;
+    while (true) {
+        service_websocket(10);
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(session_state->network_mutex);
+            inflight_count = session_state->inflight_request_ids.size();
+            long quiet_milliseconds = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                now - session_state->network_last_activity).count());
+            if (inflight_count <= static_cast<size_t>(std::max(max_inflight, 0)) && quiet_milliseconds >= idle_milliseconds) {
+                long waited = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count());
+                result.success = true;
+                result.message = "Network idle after " + std::to_string(waited) + " ms (" +
+                                 std::to_string(inflight_count) + " request(s) in flight).";
+                return result;
+            }
+        }
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() > timeout_milliseconds ||
+            !active_browser->connected) {
+            break;
+        }
+    }
+
+    // Name a few of the requests that kept the page busy.
+    std::string busy_urls;
+    {
+        std::lock_guard<std::mutex> lock(session_state->network_mutex);
+        int listed = 0;
+        for (auto entry = session_state->network_requests.rbegin();
+             entry != session_state->network_requests.rend() && listed < 3; ++entry) {
+            if (session_state->inflight_request_ids.count(entry->request_id) > 0) {
+                busy_urls += (listed++ > 0 ? ", " : "") + entry->url.substr(0, 200);
+            }
+        }
+    }
+    result.success = false;
+    result.error_detail = "Timeout waiting for network idle: " + std::to_string(inflight_count) +
+                          " request(s) in flight" + (busy_urls.empty() ? "." : " (" + busy_urls + ").");
+    result.message = "wait_for_network_idle failed.";
+    return result;
+}
+
 // --- set_geolocation, set_user_agent ---
 
 browser_driver::DriverResult set_geolocation(double latitude, double longitude, double accuracy) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "set_geolocation failed.";
@@ -2925,7 +4896,7 @@ browser_driver::DriverResult set_geolocation(double latitude, double longitude,
         params["accuracy"] = accuracy;
     }
     json response = send_command("Emulation.setGeolocationOverride", params,
-                                 global_state.current_session_id, 5000);
+                                 active_session_id(), 5000);
     if (response.contains("error") && response["error"].is_string()) {
         result.success = false;
         result.error_detail = response["error"].get<std::string>();
@@ -2940,7 +4911,7 @@ browser_driver::DriverResult set_geolocation(double latitude, double longitude,
 browser_driver::DriverResult set_user_agent(const std::string &user_agent_string) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected) {
+    if (!active_browser->connected) {
         result.success = false;
         result.error_detail = "No active browser. Call open_browser first.";
         result.message = "set_user_agent failed.";
@@ -2966,27 +4937,23 @@ browser_driver::DriverResult set_user_agent(const std::string &user_agent_string
 browser_driver::DriverResult is_visible(const std::string &selector, bool &out_visible) {
     browser_driver::DriverResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         result.message = "is_visible failed.";
         return result;
     }
 
-    std::string escaped_selector = json(selector).dump();
-    std::string script = "(function(){ var el=document.querySelector(" + escaped_selector + ");"
-        "if(!el) return false; var r=el.getBoundingClientRect();"
-        "return r.width>0 && r.height>0 && window.getComputedStyle(el).visibility!='hidden' && window.getComputedStyle(el).display!='none'; })();";
-    json eval_params;
-    eval_params["expression"] = script;
-    eval_params["returnByValue"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
+    std::string object_id;
+    if (is_element_handle(selector) && !resolve_element_handle(selector, object_id, result.error_detail)) {
+        result.success = false;
+        result.message = "is_visible failed.";
+        return result;
     }
-    json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 5000);
+    json eval_response = call_page_runtime("isVisible", json::array({selector}), 5000, object_id);
 
-    if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
+    if (eval_response.contains("error") ||
+        (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails"))) {
         result.success = false;
         result.error_detail = "Element not found or error: " + selector;
         result.message = "is_visible failed.";
@@ -3008,26 +4975,21 @@ browser_driver::DriverResult is_visible(const std::string &selector, bool &out_v
 browser_driver::BoundingBoxResult get_element_bounding_box(const std::string &selector) {
     browser_driver::BoundingBoxResult result;
 
-    if (!global_state.connected || global_state.current_session_id.empty()) {
+    if (!active_browser->connected || active_session_id().empty()) {
         result.success = false;
         result.error_detail = "No active browser session. Call open_browser first.";
         return result;
     }
 
-    std::string escaped_selector = json(selector).dump();
-    std::string script = "(function(){ var el=document.querySelector(" + escaped_selector + ");"
-        "if(!el) return null; var r=el.getBoundingClientRect();"
-        "return {x:r.x,y:r.y,width:r.width,height:r.height}; })();";
-    json eval_params;
-    eval_params["expression"] = script;
-    eval_params["returnByValue"] = true;
-    if (global_state.current_execution_context_id != 0) {
-        eval_params["contextId"] = global_state.current_execution_context_id;
+    std::string object_id;
+    if (is_element_handle(selector) && !resolve_element_handle(selector, object_id, result.error_detail)) {
+        result.success = false;
+        return result;
     }
-    json eval_response = send_command("Runtime.evaluate", eval_params,
-                                      global_state.current_session_id, 5000);
+    json eval_response = call_page_runtime("boundingBox", json::array({selector}), 5000, object_id);
 
-    if (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails")) {
+    if (eval_response.contains("error") ||
+        (eval_response.contains("result") && eval_response["result"].contains("exceptionDetails"))) {
         result.success = false;
         result.error_detail = "Element not found: " + selector;
         return result;
@@ -3061,7 +5023,7 @@ browser_driver::BoundingBoxResult get_element_bounding_box(const std::string &se
 }
 
 ConnectionState &get_state() {
-    return global_state;
+    return *active_browser;
 }
 
 } // namespace cdp_driver
@@ -6,14 +6,20 @@
 // and provides high-level functions for browser automation.
 
 #include <nlohmann/json.hpp>
+#include <chrono>
 #include <string>
 #include <map>
 #include <functional>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
+#include <memory>
+#include <set>
 #include <vector>
 
 #include "browser/browser_driver_abi.hpp"
+#include "browser/cdp/cdp_dom_snapshot.hpp"
+#include "browser/cdp/cdp_screenshot_diff.hpp"
 
 struct lws_context;
 struct lws;
@@ -22,6 +28,110 @@ namespace cdp_driver {
 
 using json = nlohmann::json;
 
+// One target known to the driver, maintained from Target.targetCreated /
+// Target.targetInfoChanged / Target.targetDestroyed (discovery is enabled in open_browser).
+struct TargetRecord {
+    std::string target_id;
+    std::string type;  // "page", "iframe", "service_worker", ...
+    std::string title;
+    std::string url;
+    std::string browser_context_id;  // empty for the default context
+};
+
+// Lifecycle of one frame's current document: its loader id and the milestones it reached
+// ("commit", "DOMContentLoaded", "load", "networkIdle", "firstMeaningfulPaint", ...).
+struct FrameLifecycle {
+    std::string loader_id;
+    std::set<std::string> events;
+    bool loading = false;  // between Page.frameStartedLoading and Page.frameStoppedLoading
+};
+
+// evaluate_javascript script cached in one execution context, keyed by a hash of its source.
+// A script seen once keeps neither source nor id; once compiled, the source is kept only to
+// rule out hash collisions before its scriptId is run.
+struct CompiledScript {
+    std::string source;
+    std::string script_id;
+};
+
+// State belonging to one attached session (one tab). Events are routed here by sessionId,
+// so background tabs keep collecting data and switching tabs needs no re-capture.
+// Each buffer is bounded and has its own lock.
+struct SessionState {
+    std::string session_id;
+    std::string target_id;
+    bool domains_enabled = false;  // Runtime/Page enabled on this session
+
+    // Console messages buffer (Runtime.consoleAPICalled).
+    std::deque<browser_driver::ConsoleEntry> console_entries;
+    std::mutex console_mutex;
+    static constexpr size_t kConsoleEntriesMax = 20000;
+
+    // Last JavaScript dialog (Page.javascriptDialogOpening): message and type.
+    std::string last_dialog_message;
+    std::string last_dialog_type;
+    std::mutex dialog_mutex;
+
+    // Frame execution context: map frame id to context id; empty = main.
+    std::map<std::string, int> execution_context_id_by_frame_id;
+    int current_execution_context_id = 0;  // 0 = use default (main frame)
+    int main_world_context_id = 0;         // default context of the main frame, 0 until reported
+    // evaluate_javascript scripts per execution context: source hash -> Runtime.compileScript
+    // scriptId (empty = seen once, compiled when it runs again). Dropped when the context is destroyed.
+    std::map<int, std::map<size_t, CompiledScript>> script_ids_by_context;
+    static constexpr size_t kCompiledScriptsMax = 64;
+    std::mutex frame_mutex;
+
+    // Page lifecycle per frame id (Page.lifecycleEvent, frameNavigated, loadEventFired, frame*Loading).
+    std::map<std::string, FrameLifecycle> lifecycle_by_frame_id;
+    std::mutex lifecycle_mutex;
+
+    // Network requests buffer (Network.requestWillBeSent / responseReceived).
+    std::deque<browser_driver::NetworkRequestEntry> network_requests;
+    std::mutex network_mutex;
+    static constexpr size_t kNetworkRequestsMax = 500;
+    bool network_enabled = false;
+    // Requests in flight (requestWillBeSent until loadingFinished / loadingFailed) and the time the
+    // set last changed, for wait_for_network_idle.
+    std::set<std::string> inflight_request_ids;
+    std::chrono::steady_clock::time_point network_last_activity = std::chrono::steady_clock::now();
+
+    // DOM cache: document root nodeId, dropped on DOM.documentUpdated / main-frame Page.frameNavigated.
+    // Selector results are not cached: mutations inside subtrees never pushed to the client send no
+    // DOM events, so a cached match could not be invalidated reliably.
+    bool dom_enabled = false;
+    int document_node_id = 0;
+    std::mutex dom_mutex;
+
+    // Last DOMSnapshot element extraction, paged through by cursor; dropped with the DOM cache root.
+    bool snapshot_elements_valid = false;
+    bool snapshot_viewport_only = false;
+    std::vector<cdp_dom_snapshot::SnapshotElement> snapshot_elements;
+
+    // Element handles from list_interactive_elements ("@<generation>:<item id>"), backed by RemoteObjectIds.
+    // Item ids are stable within a document (in-page index); a new document bumps the generation,
+    // a main-frame context reset clears the ids.
+    int handle_generation = 0;
+    std::string handle_document_id;
+    std::map<int, std::string> handle_object_id_by_item;
+    std::mutex handle_mutex;
+
+    // Page.startScreencast latest frame (capture_screenshot mode=latest): a single slot holding the
+    // newest frame by timestamp. screencast_settings = parameters the screencast was started with.
+    bool screencast_running = false;
+    std::string screencast_settings;
+    std::string screencast_frame_base64;
+    std::string screencast_mime_type;
+    double screencast_frame_timestamp = 0;  // metadata.timestamp, seconds since the epoch
+    int screencast_frame_count = 0;         // frames received since the start
+    std::mutex screencast_mutex;
+
+    // Last capture_screenshot changes_only frame, decoded: the baseline for the next one. Only
+    // compared when the region options (last_screenshot_key) and the size match.
+    cdp_screenshot_diff::Image last_screenshot;
+    std::string last_screenshot_key;
+};
+
 // State of the CDP connection.
 struct ConnectionState {
     bool connected = false;
@@ -41,10 +151,27 @@ struct ConnectionState {
     std::string current_target_id;
     std::string current_session_id;
 
+    // Tab that commands are routed to for the duration of one tool call (route_to_tab);
+    // empty = the current tab. Does not change the current tab.
+    std::string routed_target_id;
+    std::string routed_session_id;
+
+    // Target table kept up to date from Target.* discovery events, so tab listing and
+    // index resolution need no Target.getTargets round trip. Order = Target.getTargets order
+    // at open_browser, then order of discovery.
+    std::vector<TargetRecord> targets;
+    std::mutex target_mutex;
+
     // Pending request map: message id -> response JSON (filled when response arrives).
     std::map<int, json> pending_responses;
     std::mutex pending_mutex;
     std::condition_variable pending_condition;
+    // Fire-and-forget commands (screencast frame acks): their responses are dropped on arrival.
+    std::set<int> discarded_response_ids;
+
+    // Screencast frames to acknowledge: (session id, frame sessionId). Sent after lws_service
+    // returns rather than from inside the receive callback.
+    std::vector<std::pair<std::string, int>> screencast_acks_pending;
 
     // Buffer for incoming WebSocket data.
     std::string receive_buffer;
@@ -52,26 +179,9 @@ struct ConnectionState {
     // CDP WebSocket receive buffer size in bytes (configurable at init, 1–20 MB). Used for LWS rx_buffer_size and as max screenshot payload size.
     size_t cdp_rx_buffer_size = 5 * 1024 * 1024;
 
-    // Console messages buffer (Runtime.consoleAPICalled for current tab).
-    std::vector<browser_driver::ConsoleEntry> console_entries;
-    std::mutex console_mutex;
-    static constexpr size_t kConsoleEntriesMax = 20000;
-
-    // Last JavaScript dialog (Page.javascriptDialogOpening): message and type.
-    std::string last_dialog_message;
-    std::string last_dialog_type;
-    std::mutex dialog_mutex;
-
-    // Frame execution context: map frame id to context id; empty = main.
-    std::map<std::string, int> execution_context_id_by_frame_id;
-    int current_execution_context_id = 0;  // 0 = use default (main frame)
-    std::mutex frame_mutex;
-
-    // Network requests buffer (Network.requestWillBeSent / responseReceived).
-    std::vector<browser_driver::NetworkRequestEntry> network_requests;
-    std::mutex network_mutex;
-    static constexpr size_t kNetworkRequestsMax = 500;
-    bool network_enabled = false;
+    // Per-session state buckets keyed by sessionId (created on attach, dropped on detach/destroy).
+    std::map<std::string, std::shared_ptr<SessionState>> sessions_by_id;
+    std::mutex sessions_mutex;
 };
 
 // Initialize the CDP driver (set up global state). Call once at startup.
@@ -89,15 +199,26 @@ size_t get_cdp_rx_buffer_size();
 // Returns true on success.
 bool connect(const std::string &websocket_url);
 
-// Disconnect and clean up.
+// Disconnect and clean up every browser in the pool (kills the Chrome processes we launched).
 void disconnect();
 
+// Disconnect only the active browser and drop it from the pool; another connected browser becomes active.
+void disconnect_current_browser();
+
+// Number of connected browsers in the pool (open_browser with new_instance adds one).
+int browser_pool_size();
+
 // Send a CDP command and wait for the response (blocking, with timeout).
 // If session_id is non-empty, the command is routed to that session.
 // Returns the response JSON, or an error object if timed out / failed.
 json send_command(const std::string &method, const json &params,
                   const std::string &session_id = "", int timeout_milliseconds = 10000);
 
+// Pipelining: send a command without waiting (returns message id, -1 if not sent), then collect
+// its reply with wait_for_response. Several commands can be in flight before the first wait.
+int send_command_async(const std::string &method, const json &params, const std::string &session_id = "");
+json wait_for_response(int message_id, const std::string &method, int timeout_milliseconds = 10000);
+
 // Run the WebSocket event loop for a given duration (milliseconds).
 // This must be called periodically to process incoming messages.
 void service_websocket(int timeout_milliseconds);
@@ -106,13 +227,18 @@ void service_websocket(int timeout_milliseconds);
 
 // Open the browser: launch Chrome, connect via CDP, discover targets,
 // attach to a default tab. Stores current_target_id and current_session_id.
+// With options.new_instance and a browser already open, launches an additional pooled
+// Chrome (own process, profile and connection) and makes it the active one.
 browser_driver::DriverResult open_browser(const browser_driver::OpenBrowserOptions &options = {});
 
-// List all page-type targets (tabs).
+// List all page-type targets (tabs) of all pooled browsers. Served from the event-maintained target tables.
 browser_driver::TabListResult list_tabs();
 
-// Navigate the current tab to the given URL.
-browser_driver::NavigateResult navigate(const std::string &url);
+// Navigate the current tab to the given URL. With wait_until ("commit", "DOMContentLoaded", "load",
+// "networkIdle", "firstMeaningfulPaint") returns when the new document reaches that lifecycle
+// milestone; empty = return as soon as Page.navigate replies.
+browser_driver::NavigateResult navigate(const std::string &url, const std::string &wait_until = "",
+                                        int timeout_milliseconds = 30000);
 
 // Go back in the current tab's history.
 browser_driver::DriverResult navigate_back();
@@ -127,35 +253,65 @@ browser_driver::DriverResult refresh();
 browser_driver::NavigationHistoryResult get_navigation_history();
 
 // Create a new tab (optionally with URL) and attach to it as the current target.
-browser_driver::DriverResult new_tab(const std::string &url = "about:blank");
+// If browser_context_id is set, the tab is opened in that isolated context; otherwise, with
+// several pooled browsers, it is opened in the one with the fewest tabs.
+browser_driver::DriverResult new_tab(const std::string &url = "about:blank",
+                                     const std::string &browser_context_id = "");
+
+// Isolated browser contexts (Target.createBrowserContext): clean cookies/storage without relaunching Chrome.
+// Disposing a context closes its tabs; if the current tab was one of them, the first remaining tab is attached.
+browser_driver::CreateBrowserContextResult create_browser_context();
+browser_driver::DriverResult dispose_browser_context(const std::string &browser_context_id);
 
-// Switch to tab by 0-based index (page targets only). Returns success and attaches to that tab.
+// Switch to tab by 0-based index into list_tabs (may switch the active pooled browser). Attaches to that tab.
 browser_driver::DriverResult switch_tab(int index);
 
 // Close the current tab. If other page targets exist, attaches to the first one.
 browser_driver::DriverResult close_tab();
 
+// Route subsequent driver calls to another tab without making it current (attaches if needed).
+// tab_id is a target id or 0-based index from list_tabs; "" routes back to the current tab.
+bool route_to_tab(const std::string &tab_id, std::string &out_error);
+
 // Capture a screenshot of the current tab. Returns base64 image data and mime type.
 // Options: format (png/jpeg), quality (for jpeg). Default jpeg@85 to avoid large payloads (413).
 browser_driver::CaptureScreenshotResult capture_screenshot(
     const browser_driver::CaptureScreenshotOptions &options = {});
 
-// Enable Runtime for the current session and clear console buffer. Call after attach.
+// Enable Runtime and Page for the current session (once per session; buffers are kept). Call after attach.
 void enable_console_for_session();
 
 // Get console messages with time/level/count scope. Includes time_sync when possible.
 browser_driver::ConsoleMessagesResult get_console_messages(
     const browser_driver::GetConsoleMessagesOptions &options);
 
-// List form fields and clickable elements (label, placeholder, text, selector). Max ~100.
-browser_driver::ListInteractiveElementsResult list_interactive_elements();
+// List form fields and clickable elements (label, placeholder, text, handle). Max 100 per call.
+// Served from an in-page index kept current by a MutationObserver. With since_token (a previous
+// result's version_token) only elements changed since then and removed handles are returned.
+browser_driver::ListInteractiveElementsResult list_interactive_elements(const std::string &since_token = "");
+
+// Same element set from one DOMSnapshot.captureSnapshot (layout and styles in a single transfer),
+// filtered in C++: no per-element layout in the page and no cap. Pages of kSnapshotPageSize from
+// cursor; cursor 0 captures a new snapshot, later pages reuse it. Handles are "@n<backendNodeId>".
+static constexpr int kSnapshotPageSize = 200;
+browser_driver::ListInteractiveElementsResult list_interactive_elements_snapshot(int cursor, bool viewport_only);
+
+// Element actions take an optional timeout_milliseconds: when > 0 the page first waits (one awaited
+// call) until the element is actionable: attached, visible, stable, enabled (clicks), editable
+// (fill) and receiving pointer events at its center (mouse actions). 0 = act on the current state.
 
 // Fill an input/textarea by selector. Optionally clear before typing.
 browser_driver::DriverResult fill_field(const std::string &selector, const std::string &value,
-                                        bool clear_first = true);
+                                        bool clear_first = true, int timeout_milliseconds = 0);
+
+// Fill many fields in one page call: text inputs and textareas get their value set with input and
+// change events, checkboxes/radios are clicked to the wanted state, select options are picked by
+// value or label. Only type_text and contenteditable fields are typed with Input.insertText.
+browser_driver::FillFormResult fill_form(const std::vector<browser_driver::FormField> &fields);
 
-// Click an element by selector (uses box model + Input.dispatchMouseEvent, fallback element.click()).
-browser_driver::DriverResult click_element(const std::string &selector);
+// Click an element by selector (uses box model + Input.dispatchMouseEvent, fallback element.click()
+// when covered and not waiting).
+browser_driver::DriverResult click_element(const std::string &selector, int timeout_milliseconds = 0);
 
 // Click at viewport coordinates (e.g. canvas). x, y in CSS pixels.
 browser_driver::DriverResult click_at_coordinates(int x, int y);
@@ -171,23 +327,33 @@ browser_driver::EvaluateJavaScriptResult evaluate_javascript(const std::string &
                                                             int timeout_milliseconds = 10000);
 
 // Hover over element by selector (mouse move to element center).
-browser_driver::DriverResult hover_element(const std::string &selector);
+browser_driver::DriverResult hover_element(const std::string &selector, int timeout_milliseconds = 0);
 
 // Double-click element by selector.
-browser_driver::DriverResult double_click_element(const std::string &selector);
+browser_driver::DriverResult double_click_element(const std::string &selector, int timeout_milliseconds = 0);
 
 // Right-click element by selector.
-browser_driver::DriverResult right_click_element(const std::string &selector);
+browser_driver::DriverResult right_click_element(const std::string &selector, int timeout_milliseconds = 0);
 
 // Drag from source to target by selectors; or by coordinates (for canvas etc.).
 browser_driver::DriverResult drag_and_drop_selectors(const std::string &source_selector,
-                                                     const std::string &target_selector);
+                                                     const std::string &target_selector,
+                                                     int timeout_milliseconds = 0);
 browser_driver::DriverResult drag_from_to_coordinates(int x1, int y1, int x2, int y2);
 
 // Page source and outer HTML.
 browser_driver::GetPageSourceResult get_page_source();
 browser_driver::GetPageSourceResult get_outer_html(const std::string &selector);
 
+// Readable page (or element) text as markdown: at most max_bytes of UTF-8 from cursor.
+// The text is extracted in one page call and kept in the page for the following cursors.
+browser_driver::GetPageTextResult get_page_text(const std::string &selector, int cursor, int max_bytes);
+
+// Compact accessibility outline (Accessibility.getFullAXTree pruned in C++, see cdp_ax_outline).
+// selector (CSS or handle) scopes it to a subtree; viewport_only keeps nodes whose box is in view.
+browser_driver::GetAccessibilityTreeResult get_accessibility_tree(const std::string &selector, bool viewport_only,
+                                                                  int max_lines);
+
 // Keyboard: send_keys (optional selector for focus), key_press, key_down, key_up.
 browser_driver::DriverResult send_keys(const std::string &keys,
                                        const std::string &selector = "");
@@ -196,10 +362,14 @@ browser_driver::DriverResult key_down(const std::string &key);
 browser_driver::DriverResult key_up(const std::string &key);
 
 // Wait: sleep seconds; wait for selector or navigation with timeout.
+// wait_for_selector waits in the page (MutationObserver/rAF, one Runtime call) for state
+// "attached", "detached", "visible", "hidden" or "enabled".
 browser_driver::DriverResult wait_seconds(double seconds);
 browser_driver::DriverResult wait_for_selector(const std::string &selector,
-                                               int timeout_milliseconds);
-browser_driver::DriverResult wait_for_navigation(int timeout_milliseconds);
+                                               int timeout_milliseconds,
+                                               const std::string &state = "attached");
+// wait_for_navigation waits for a lifecycle milestone (default "load") of the main frame's current document.
+browser_driver::DriverResult wait_for_navigation(int timeout_milliseconds, const std::string &wait_until = "load");
 
 // Cookies.
 browser_driver::GetCookiesResult get_cookies(const std::string &url = "");
@@ -238,6 +408,10 @@ browser_driver::DriverResult set_clipboard(const std::string &text);
 // Network: enable and buffer requests; return list.
 browser_driver::GetNetworkRequestsResult get_network_requests();
 
+// Wait until at most max_inflight requests have been in flight for idle_milliseconds, counted from
+// Network.requestWillBeSent / loadingFinished / loadingFailed (Network is enabled on first use).
+browser_driver::DriverResult wait_for_network_idle(int idle_milliseconds, int max_inflight, int timeout_milliseconds);
+
 // Geolocation and user agent.
 browser_driver::DriverResult set_geolocation(double latitude, double longitude,
                                              double accuracy = 0.0);
@@ -0,0 +1,643 @@
+#include "browser/cdp/cdp_page_runtime.hpp"
+
+using json = nlohmann::json;
+
+namespace cdp_page_runtime {
+
+// Bump whenever a function below changes, so pages holding an older copy get it replaced.
+static constexpr int kRuntimeVersion = 5;
+static const char kMissingMarker[] = "__bmcps_missing__";
+
+// Selector engine behind every selector argument. Plain CSS goes straight to querySelector;
+// otherwise the selector is split on >> (search inside the previous match) and >>> (the same,
+// piercing shadow roots), and each part is css=, text= (innermost element whose text matches),
+// xpath= (or a leading //) or role=<role>[name=...] with implicit ARIA roles. text and name take
+// "exact", /regex/flags or a case-insensitive substring. Returns the first match, or all with all.
+static const char kQueryFunction[] = R"JS(function(selector, all) {
+  // Split on >> (search inside the previous match) and >>> (same, piercing shadow roots),
+  // outside quotes and brackets.
+  const parts = [];
+  let start = 0, quote = '', depth = 0, pierce = false;
+  for (let i = 0; i < selector.length; i++) {
+    const c = selector[i];
+    if (quote) { if (c === '\\') i++; else if (c === quote) quote = ''; continue; }
+    if (c === '"' || c === "'") quote = c;
+    else if (c === '[' || c === '(') depth++;
+    else if (c === ']' || c === ')') depth--;
+    else if (c === '>' && depth === 0 && selector[i + 1] === '>') {
+      parts.push({body: selector.slice(start, i).trim(), pierce: pierce});
+      pierce = selector[i + 2] === '>';
+      i += pierce ? 2 : 1;
+      start = i + 1;
+    }
+  }
+  parts.push({body: selector.slice(start).trim(), pierce: pierce});
+  const engine = /^(css|text|xpath|role)=/;
+  const isXPath = (body) => /^\(*\/\//.test(body);
+  if (parts.length === 1 && !engine.test(selector) && !isXPath(selector) && !/^["']/.test(selector)) {
+    return all ? Array.from(document.querySelectorAll(selector)) : document.querySelector(selector);
+  }
+
+  const normalize = (s) => (s || '').replace(/\s+/g, ' ').trim();
+  // "quoted" = exact, /re/flags = regex, otherwise case-insensitive substring.
+  const matcher = (pattern) => {
+    pattern = pattern.trim();
+    const q = /^(["'])(.*)\1$/.exec(pattern);
+    if (q) { const want = normalize(q[2].replace(/\\(.)/g, '$1')); return (s) => normalize(s) === want; }
+    const r = /^\/(.*)\/([a-z]*)$/.exec(pattern);
+    if (r) { const re = new RegExp(r[1], r[2]); return (s) => re.test(normalize(s)); }
+    const want = normalize(pattern).toLowerCase();
+    return (s) => normalize(s).toLowerCase().includes(want);
+  };
+  const SKIP = {SCRIPT: 1, STYLE: 1, NOSCRIPT: 1, TEMPLATE: 1, HEAD: 1, TITLE: 1};
+  const ownText = (el) => {
+    if (el.tagName === 'INPUT' && /^(button|submit|reset)$/i.test(el.type)) return el.value;
+    return el.textContent;
+  };
+  const implicitRole = (el) => {
+    const tag = el.tagName.toLowerCase(), type = (el.getAttribute('type') || '').toLowerCase();
+    if (tag === 'a' || tag === 'area') return el.hasAttribute('href') ? 'link' : '';
+    if (tag === 'input') {
+      if (/^(button|submit|reset|image)$/.test(type)) return 'button';
+      if (type === 'checkbox' || type === 'radio') return type;
+      if (type === 'range') return 'slider';
+      if (type === 'number') return 'spinbutton';
+      if (type === 'search') return 'searchbox';
+      if (type === 'hidden') return '';
+      return el.hasAttribute('list') ? 'combobox' : 'textbox';
+    }
+    if (tag === 'select') return el.multiple || el.size > 1 ? 'listbox' : 'combobox';
+    if (/^h[1-6]$/.test(tag)) return 'heading';
+    return {button: 'button', textarea: 'textbox', option: 'option', img: 'img', nav: 'navigation',
+            main: 'main', header: 'banner', footer: 'contentinfo', aside: 'complementary', form: 'form',
+            dialog: 'dialog', ul: 'list', ol: 'list', li: 'listitem', table: 'table', tr: 'row',
+            td: 'cell', th: 'columnheader', progress: 'progressbar', summary: 'button',
+            article: 'article', section: el.hasAttribute('aria-label') ? 'region' : ''}[tag] || '';
+  };
+  const roleOf = (el) => (el.getAttribute('role') || '').trim().split(/\s+/)[0] || implicitRole(el);
+  const nameOf = (el) => {
+    const ids = el.getAttribute('aria-labelledby');
+    if (ids) {
+      const text = ids.split(/\s+/).map((id) => { const l = document.getElementById(id); return l ? l.textContent : ''; }).join(' ');
+      if (normalize(text)) return text;
+    }
+    if (el.getAttribute('aria-label')) return el.getAttribute('aria-label');
+    if (el.labels && el.labels.length && !/^(button|submit|reset)$/i.test(el.type || '')) {
+      return Array.from(el.labels).map((l) => l.textContent).join(' ');
+    }
+    if (el.tagName === 'IMG' || (el.tagName === 'INPUT' && el.type === 'image')) return el.getAttribute('alt') || el.title;
+    if (/^(INPUT|TEXTAREA|SELECT)$/.test(el.tagName) && !/^(button|submit|reset)$/i.test(el.type || '')) {
+      return el.getAttribute('placeholder') || el.title;
+    }
+    return normalize(ownText(el)) || el.title || '';
+  };
+
+  // Elements below root (a Document, Element or ShadowRoot) matching one part, in document order.
+  const elementsIn = (root) => Array.from(root.querySelectorAll('*')).filter((el) => !SKIP[el.tagName]);
+  const matchPart = (body, root) => {
+    const prefix = engine.exec(body);
+    const kind = prefix ? prefix[1] : isXPath(body) ? 'xpath' : /^["']/.test(body) ? 'text' : 'css';
+    const value = prefix ? body.slice(prefix[0].length) : body;
+    if (kind === 'css') return Array.from(root.querySelectorAll(value));
+    if (kind === 'xpath') {
+      const found = [];
+      const snapshot = document.evaluate(value, root, null, XPathResult.ORDERED_NODE_SNAPSHOT_TYPE, null);
+      for (let k = 0; k < snapshot.snapshotLength; k++) {
+        const node = snapshot.snapshotItem(k);
+        if (node.nodeType === 1) found.push(node);
+      }
+      return found;
+    }
+    if (kind === 'text') {
+      // The innermost elements whose text matches (a match's ancestors match too).
+      const test = matcher(value);
+      const hits = elementsIn(root).filter((el) => test(ownText(el)));
+      const hitSet = new Set(hits);
+      return hits.filter((el) => !Array.from(el.children).some((child) => hitSet.has(child)));
+    }
+    const r = /^([\w-]+)\s*(?:\[\s*name\s*=\s*(.+)\])?\s*$/.exec(value);
+    if (!r) throw new Error('Invalid role selector: ' + body);
+    const test = r[2] !== undefined ? matcher(r[2]) : null;
+    return elementsIn(root).filter((el) => roleOf(el) === r[1] && (!test || test(nameOf(el))));
+  };
+  // With piercing, a scope also searches every shadow root below it.
+  const rootsOf = (scope, deep) => {
+    const roots = [scope];
+    if (!deep) return roots;
+    if (scope.shadowRoot) roots.push(scope.shadowRoot);
+    for (let k = 0; k < roots.length; k++) {
+      for (const el of roots[k].querySelectorAll('*')) if (el.shadowRoot) roots.push(el.shadowRoot);
+    }
+    return roots;
+  };
+
+  let scopes = [document];
+  for (const part of parts) {
+    if (!part.body) throw new Error('Empty part in selector: ' + selector);
+    const next = new Set();
+    for (const scope of scopes) {
+      for (const root of rootsOf(scope, part.pierce)) {
+        for (const el of matchPart(part.body, root)) next.add(el);
+      }
+    }
+    scopes = Array.from(next);
+    if (!scopes.length) break;
+  }
+  return all ? scopes : (scopes[0] || null);
+})JS";
+
+// Waits (in the page, one awaited call) until the selector or handle element passes the checks:
+// attached, then visible, stable (same box on two consecutive frames), enabled, editable and
+// hit (its center receives pointer events), each only when set in checks. Resolves {el} or, at
+// the timeout, {el, reason} naming the first check that still failed.
+static const char kActionableFunction[] = R"JS(function(selector, checks, timeout) {
+  const handle = this && this.nodeType === 1 ? this : null;
+  const deadline = performance.now() + timeout;
+  let scrolled = null, last = null, lastRect = null;
+  const describe = (node) => node.tagName.toLowerCase() + (node.id ? '#' + node.id : '') +
+    (typeof node.className === 'string' && node.className.trim() ? '.' + node.className.trim().split(/\s+/).join('.') : '');
+  const check = (el) => {
+    if (!el) return 'not attached';
+    if (checks.visible || checks.stable || checks.hit) {
+      if (scrolled !== el) { el.scrollIntoView({block: 'center', inline: 'center', behavior: 'instant'}); scrolled = el; }
+      const r = el.getBoundingClientRect();
+      if (!(r.width > 0 && r.height > 0) || window.getComputedStyle(el).visibility === 'hidden') return 'not visible';
+      const same = el === last && lastRect && r.x === lastRect.x && r.y === lastRect.y &&
+                   r.width === lastRect.width && r.height === lastRect.height;
+      last = el; lastRect = r;
+      if (checks.stable && !same) return 'not stable (moving or animating)';
+    }
+    if (checks.enabled && (el.matches(':disabled') || el.getAttribute('aria-disabled') === 'true')) return 'disabled';
+    if (checks.editable && (el.readOnly || !(el.isContentEditable || /^(INPUT|TEXTAREA|SELECT)$/.test(el.tagName)))) {
+      return 'not editable';
+    }
+    if (checks.hit) {
+      const r = el.getBoundingClientRect();
+      const root = el.getRootNode();
+      const hit = (root.elementFromPoint ? root : document).elementFromPoint(r.left + r.width / 2, r.top + r.height / 2);
+      if (!hit) return 'outside the viewport';
+      if (hit !== el && !el.contains(hit)) return 'covered by ' + describe(hit);
+    }
+    return '';
+  };
+  return new Promise((resolve) => {
+    const step = () => {
+      const el = handle ? (handle.isConnected ? handle : null) : window.__bmcps.query(selector);
+      const reason = check(el);
+      if (!reason) return resolve({el: el});
+      if (performance.now() >= deadline) return resolve({el: el, reason: reason});
+      // Animation frames do not run in background tabs; poll there instead.
+      if (document.hidden) setTimeout(step, 16); else requestAnimationFrame(step);
+    };
+    step();
+  });
+})JS";
+
+// Viewport point of the element center for mouse actions: scrolls it into view, hit-tests the
+// center and maps iframe coordinates to the top-level viewport (resolve_element_point). With
+// wait = {timeout, checks} it first waits for actionability and reports the failing check instead
+// of clicking in the page.
+static const char kResolvePointFunction[] = R"JS(function(selector, clickIfObscured, wait) {
+  const point = (el, clickFallback) => {
+    el.scrollIntoView({block: 'center', inline: 'center', behavior: 'instant'});
+    const r = el.getBoundingClientRect();
+    let x = r.left + r.width / 2, y = r.top + r.height / 2;
+    // Hit-test in the element's own tree so shadow DOM content is not retargeted to its host.
+    const root = el.getRootNode();
+    const hit = (root.elementFromPoint ? root : document).elementFromPoint(x, y);
+    const hittable = r.width > 0 && r.height > 0 && !!hit && (hit === el || el.contains(hit));
+    if (!hittable && clickFallback) { el.click(); return {found: true, hittable: false, clicked: true}; }
+    try {
+      for (let w = window; w !== w.top && w.frameElement; w = w.parent) {
+        const f = w.frameElement.getBoundingClientRect();
+        x += f.left + w.frameElement.clientLeft;
+        y += f.top + w.frameElement.clientTop;
+      }
+    } catch (e) {}
+    return {found: true, hittable: hittable, x: x, y: y, width: r.width, height: r.height};
+  };
+  if (wait && wait.timeout > 0) {
+    return window.__bmcps.actionable.call(this, selector, wait.checks, wait.timeout).then((state) =>
+      state.reason ? {found: !!state.el, hittable: false, reason: state.reason} : point(state.el, false));
+  }
+  const el = this && this.nodeType === 1 ? this : window.__bmcps.query(selector);
+  if (!el) return {found: false};
+  return point(el, clickIfObscured);
+})JS";
+
+// In-page element index for list_interactive_elements, installed once per document as
+// window.__bmcpsIndex. A MutationObserver records which subtrees changed; a listing only rescans
+// those (no full querySelectorAll, no layout) and returns nothing when the page is unchanged.
+// Each item has a stable id and the version it last changed at, so a caller can ask for the
+// delta since a version token "<document id>:<version>". Returns the elements by reference
+// (for handles) with the description JSON in .meta.
+static const char kInteractiveIndexFunction[] = R"JS(function(since, max) {
+  var SEL = 'input,textarea,button,[role=button],a,option,[role=option]';
+  var ix = window.__bmcpsIndex;
+  if (!ix || ix.doc !== document) {
+    ix = window.__bmcpsIndex = {doc: document, id: Math.random().toString(36).slice(2, 10), version: 0, floor: 0,
+                                nextId: 0, items: new Map(), byEl: new WeakMap(), removed: [],
+                                dirty: new Set(), full: true, prune: false, recheck: false};
+    new MutationObserver(function(records) {
+      for (var r of records) {
+        if (r.type === 'childList') {
+          r.addedNodes.forEach(function(n) { ix.dirty.add(n); });
+          if (r.removedNodes.length) ix.prune = true;
+        } else {
+          ix.dirty.add(r.target);
+          if (r.type === 'attributes') ix.recheck = true;  // class/style/hidden may change visibility anywhere below
+        }
+      }
+    }).observe(document, {subtree: true, childList: true, attributes: true, characterData: true});
+  }
+  function describe(el) {
+    var label = '';
+    if (el.id) { var lbl = document.querySelector('label[for="' + CSS.escape(el.id) + '"]'); if (lbl) label = (lbl.innerText || '').trim().substring(0, 200); }
+    if (!label && el.placeholder) label = el.placeholder;
+    if (!label && el.getAttribute('aria-label')) label = el.getAttribute('aria-label') || '';
+    return {role: el.getAttribute('role') || (el.tagName === 'A' ? 'link' : el.tagName.toLowerCase()),
+            label: label, placeholder: (el.placeholder || ''), type: (el.type || ''),
+            text: (el.innerText || '').trim().substring(0, 200),
+            visible: !!el.offsetParent || el.tagName === 'INPUT' || el.tagName === 'TEXTAREA' ||
+                     el.tagName === 'OPTION' || el.getAttribute('role') === 'option'};
+  }
+  function upsert(el) {
+    var info = describe(el), key = JSON.stringify(info), id = ix.byEl.get(el);
+    if (id === undefined) {
+      id = ix.nextId++;
+      ix.byEl.set(el, id);
+      ix.items.set(id, {el: el, key: key, info: info, v: ix.version});
+    } else {
+      var it = ix.items.get(id);
+      if (it && it.key !== key) { it.key = key; it.info = info; it.v = ix.version; }
+    }
+  }
+  function scan(node) {
+    var root = node.nodeType === 1 ? node : node.parentElement;
+    if (!root || !root.isConnected) return;
+    for (var a = root; a; a = a.parentElement) if (a.matches(SEL)) upsert(a);  // text/label of enclosing controls
+    root.querySelectorAll(SEL).forEach(upsert);
+  }
+  if (ix.full || ix.dirty.size || ix.prune || ix.recheck) {
+    ix.version++;
+    if (ix.full) {
+      document.querySelectorAll(SEL).forEach(upsert);
+    } else {
+      if (ix.prune) {
+        ix.items.forEach(function(it, id) {
+          if (!it.el.isConnected) { ix.items.delete(id); ix.removed.push({id: id, v: ix.version}); }
+        });
+      }
+      ix.dirty.forEach(scan);
+      if (ix.recheck) ix.items.forEach(function(it) { upsert(it.el); });
+    }
+    ix.full = ix.prune = ix.recheck = false;
+    ix.dirty.clear();
+    while (ix.removed.length > 2000) ix.floor = ix.removed.shift().v;
+  }
+  var parts = String(since || '').split(':');
+  var delta = parts.length === 2 && parts[0] === ix.id && +parts[1] >= ix.floor && +parts[1] <= ix.version;
+  var sinceVersion = delta ? +parts[1] : -1;
+  var els = [], out = [], removed = [], truncated = false;
+  ix.items.forEach(function(it, id) {
+    if (it.v <= sinceVersion) return;
+    if (!it.info.visible) { if (delta) removed.push(id); return; }
+    if (els.length >= max) { truncated = true; return; }
+    els.push(it.el);
+    var o = Object.assign({id: id}, it.info);
+    delete o.visible;
+    out.push(o);
+  });
+  if (delta) ix.removed.forEach(function(r) { if (r.v > sinceVersion) removed.push(r.id); });
+  els.meta = JSON.stringify({document: ix.id, token: ix.id + ':' + ix.version, delta: delta,
+                             items: out, removed: removed, truncated: truncated});
+  return els;
+})JS";
+
+// Focuses a form field for fill_field, optionally clearing its value first (firing input/change).
+// With wait = {timeout} it first waits until the field is visible, enabled and editable and
+// returns {reason} when it is not by the timeout.
+static const char kFocusFieldFunction[] = R"JS(function(selector, clearFirst, wait) {
+  const focus = (el) => {
+    el.focus();
+    if (clearFirst) {
+      el.value = '';
+      el.dispatchEvent(new Event('input', {bubbles: true}));
+      el.dispatchEvent(new Event('change', {bubbles: true}));
+    }
+    return {focused: true};
+  };
+  if (wait && wait.timeout > 0) {
+    return window.__bmcps.actionable.call(this, selector, {visible: true, enabled: true, editable: true}, wait.timeout)
+      .then((state) => state.reason ? {reason: state.reason} : focus(state.el));
+  }
+  const el = this && this.nodeType === 1 ? this : window.__bmcps.query(selector);
+  if (!el) throw new Error('Element not found: ' + selector);
+  return focus(el);
+})JS";
+
+// Readable text of the page (or an element) as markdown-ish text: headings, paragraphs, lists,
+// links, code and table rows; scripts, styles and hidden subtrees are skipped. The full text is
+// extracted once and kept in the page (window.__bmcpsText), so later cursors only slice it and
+// each call ships at most maxBytes of UTF-8 back.
+static const char kPageTextFunction[] = R"JS(function(selector, cursor, maxBytes) {
+  const root = this && this.nodeType === 1 ? this
+             : (selector ? window.__bmcps.query(selector) : (document.body || document.documentElement));
+  if (!root) return {found: false};
+  let cache = window.__bmcpsText;
+  if (!(cursor > 0 && cache && cache.doc === document && cache.root === root)) {
+    const SKIP = new Set(['SCRIPT', 'STYLE', 'NOSCRIPT', 'TEMPLATE', 'SVG', 'CANVAS', 'IFRAME', 'HEAD', 'OBJECT',
+                          'EMBED', 'SELECT', 'INPUT', 'TEXTAREA']);
+    const BLOCK = /^(P|DIV|SECTION|ARTICLE|MAIN|HEADER|FOOTER|NAV|ASIDE|FORM|FIELDSET|FIGURE|FIGCAPTION|BLOCKQUOTE|ADDRESS|DL|DT|DD|TABLE|UL|OL|DETAILS|SUMMARY)$/;
+    const parts = [], pre = [];
+    const inline = (s) => s.replace(/\s+/g, ' ');
+    const children = (node, depth) => {
+      for (let c = node.firstChild; c; c = c.nextSibling) walk(c, depth);
+      if (node.shadowRoot) for (let c = node.shadowRoot.firstChild; c; c = c.nextSibling) walk(c, depth);
+    };
+    const walk = (node, depth) => {
+      if (node.nodeType === 3) { parts.push(inline(node.data)); return; }
+      if (node.nodeType !== 1) return;
+      const tag = node.tagName.toUpperCase();
+      if (SKIP.has(tag) || node.hidden || node.getAttribute('aria-hidden') === 'true') return;
+      if (node.checkVisibility && !node.checkVisibility()) return;
+      let m;
+      if ((m = /^H([1-6])$/.exec(tag))) {
+        parts.push('\n\n' + '#'.repeat(+m[1]) + ' '); children(node, depth); parts.push('\n\n');
+      } else if (tag === 'A') {
+        const start = parts.length;
+        children(node, depth);
+        const label = parts.splice(start).join('').replace(/\s+/g, ' ').trim();
+        const href = node.getAttribute('href');
+        if (label) parts.push(href && !/^(javascript:|#)/i.test(href) ? '[' + label + '](' + node.href + ')' : label);
+      } else if (tag === 'IMG') {
+        if (node.alt) parts.push('![' + inline(node.alt) + ']');
+      } else if (tag === 'BR') {
+        parts.push('\n');
+      } else if (tag === 'HR') {
+        parts.push('\n\n---\n\n');
+      } else if (tag === 'PRE') {
+        pre.push(node.textContent.replace(/\n+$/, ''));
+        parts.push('\n\n```\n\u0000' + (pre.length - 1) + '\u0000\n```\n\n');
+      } else if (tag === 'CODE') {
+        parts.push('`'); children(node, depth); parts.push('`');
+      } else if (tag === 'STRONG' || tag === 'B') {
+        parts.push('**'); children(node, depth); parts.push('**');
+      } else if (tag === 'LI') {
+        const ordered = node.parentElement && node.parentElement.tagName === 'OL';
+        parts.push('\n' + '\u0001'.repeat(depth) +
+                   (ordered ? (Array.prototype.indexOf.call(node.parentElement.children, node) + 1) + '. ' : '- '));
+        children(node, depth + 1);
+      } else if (tag === 'TR') {
+        children(node, depth); parts.push(' |\n');
+      } else if (tag === 'TD' || tag === 'TH') {
+        parts.push(' | '); children(node, depth);
+      } else if (tag === 'BUTTON') {
+        parts.push(' ['); children(node, depth); parts.push('] ');
+      } else {
+        // A list nested in a list item continues it (each item starts its own line).
+        const gap = (tag === 'UL' || tag === 'OL') && depth > 0 ? '' : '\n\n';
+        const block = BLOCK.test(tag);
+        if (block) parts.push(gap);
+        children(node, depth);
+        if (block) parts.push(gap);
+      }
+    };
+    walk(root, 0);
+    const text = parts.join('')
+      .replace(/[ \t]+/g, ' ').replace(/ *\n */g, '\n').replace(/\n{3,}/g, '\n\n')
+      .replace(/\u0001/g, '  ').replace(/\u0000(\d+)\u0000/g, (_, i) => pre[+i]).trim();
+    cache = window.__bmcpsText = {doc: document, root: root, text: text};
+  }
+  const text = cache.text, total = text.length, encoder = new TextEncoder();
+  const start = Math.min(Math.max(cursor | 0, 0), total);
+  let end = Math.min(total, start + maxBytes);
+  let bytes = encoder.encode(text.slice(start, end)).length;
+  while (bytes > maxBytes && end > start + 1) {
+    end = start + Math.max(1, Math.floor((end - start) * maxBytes / bytes));
+    bytes = encoder.encode(text.slice(start, end)).length;
+  }
+  if (end < total) {
+    const cut = Math.max(text.lastIndexOf('\n', end - 1), text.lastIndexOf(' ', end - 1));
+    if (cut > start + (end - start) / 2) end = cut + 1;
+    const code = text.charCodeAt(end - 1);
+    if (code >= 0xD800 && code <= 0xDBFF) end--;
+  }
+  return {found: true, text: text.slice(start, end), next: end < total ? end : -1, total: total};
+})JS";
+
+// Waits in the page: resolves as soon as the selector (or handle element, as `this`) reaches the
+// state, re-checking on DOM mutations and, for visibility states, on every animation frame.
+// Mutations inside shadow trees do not reach a document observer, so open shadow roots are
+// observed too, and >>> selectors (or handles in a shadow tree) also poll every animation frame
+// to catch shadow roots attached later. The timeout runs in the page too, so the whole wait is one
+// Runtime call.
+static const char kWaitForSelectorFunction[] = R"JS(function(selector, state, timeout) {
+  const handle = this && this.nodeType === 1 ? this : null;
+  const find = () => handle ? (handle.isConnected ? handle : null) : window.__bmcps.query(selector);
+  const visible = (el) => {
+    const style = getComputedStyle(el);
+    if (style.visibility === 'hidden' || style.visibility === 'collapse') return false;
+    const r = el.getBoundingClientRect();
+    return r.width > 0 && r.height > 0;
+  };
+  const check = () => {
+    const el = find();
+    if (state === 'detached') return !el;
+    if (state === 'visible') return !!el && visible(el);
+    if (state === 'hidden') return !el || !visible(el);
+    if (state === 'enabled') return !!el && !el.matches(':disabled') && el.getAttribute('aria-disabled') !== 'true';
+    return !!el;
+  };
+  const start = performance.now();
+  if (check()) return {ok: true, elapsed: 0};
+  return new Promise((resolve) => {
+    let done = false, frame = 0, timer = 0;
+    const observer = new MutationObserver(() => { if (check()) finish(true); });
+    const finish = (ok) => {
+      if (done) return;
+      done = true;
+      observer.disconnect();
+      cancelAnimationFrame(frame);
+      clearTimeout(timer);
+      resolve({ok: ok, elapsed: Math.round(performance.now() - start)});
+    };
+    const options = {subtree: true, childList: true, attributes: true};
+    observer.observe(document, options);
+    const shadow = (handle && handle.getRootNode() !== document) || (!handle && selector.indexOf('>>>') >= 0);
+    if (shadow) {
+      const walker = document.createTreeWalker(document, NodeFilter.SHOW_ELEMENT);
+      const roots = [];
+      for (let node = walker.nextNode(); node; node = walker.nextNode()) if (node.shadowRoot) roots.push(node.shadowRoot);
+      for (let k = 0; k < roots.length; k++) {
+        observer.observe(roots[k], options);
+        const inner = document.createTreeWalker(roots[k], NodeFilter.SHOW_ELEMENT);
+        for (let node = inner.nextNode(); node; node = inner.nextNode()) if (node.shadowRoot) roots.push(node.shadowRoot);
+      }
+    }
+    if (shadow || state === 'visible' || state === 'hidden') {
+      const tick = () => { if (check()) finish(true); else frame = requestAnimationFrame(tick); };
+      frame = requestAnimationFrame(tick);
+    }
+    timer = setTimeout(() => finish(false), timeout);
+  });
+})JS";
+
+// fill_form: fills every field in one call. Text fields get the value through the native setter
+// plus input/change events, checkboxes and radios are clicked into the wanted state, select options
+// are picked by value or label. Element handles arrive as extra arguments (field.element = index).
+// Returns one {} / {error} / {typing: true} (left for Input.insertText) per field.
+static const char kFillFormFunction[] = R"JS(function(fields) {
+  const elements = Array.prototype.slice.call(arguments, 1);
+  const fire = (el) => {
+    el.dispatchEvent(new Event('input', {bubbles: true}));
+    el.dispatchEvent(new Event('change', {bubbles: true}));
+  };
+  const truthy = (value) => value === true || /^(true|on|yes|1|checked)$/i.test(String(value));
+  // Native setter, so frameworks that track the value property (React) see the change.
+  const setValue = (el, value) => {
+    const proto = el.tagName === 'TEXTAREA' ? HTMLTextAreaElement.prototype : HTMLInputElement.prototype;
+    Object.getOwnPropertyDescriptor(proto, 'value').set.call(el, value);
+  };
+  const fill = (field, el) => {
+    if (!el || !el.isConnected) return {error: 'not found'};
+    if (el.matches(':disabled')) return {error: 'disabled'};
+    const tag = el.tagName, type = (el.getAttribute('type') || '').toLowerCase();
+    const value = field.value;
+    if (tag === 'INPUT' && (type === 'checkbox' || type === 'radio')) {
+      let target = el;
+      if (type === 'radio' && typeof value !== 'boolean' && el.value !== String(value)) {
+        // A radio of the group: pick the one with that value (or label text).
+        const scope = el.form || el.getRootNode();
+        target = Array.from(scope.querySelectorAll('input[type=radio]')).find((radio) => radio.name === el.name &&
+          (radio.value === String(value) || (radio.labels && Array.from(radio.labels).some((l) => l.textContent.trim() === String(value)))));
+        if (!target) return {error: 'no radio with value ' + JSON.stringify(value)};
+      }
+      const want = type === 'radio' && typeof value !== 'boolean' ? true : truthy(value);
+      // click() toggles like a user would and fires click/input/change.
+      if (target.checked !== want) target.click();
+      return target.checked === want ? {} : {error: 'state did not change (prevented by the page?)'};
+    }
+    if (tag === 'SELECT') {
+      const wanted = (Array.isArray(value) ? value : [value]).map(String);
+      const options = Array.from(el.options);
+      const picks = wanted.map((w) => options.find((o) => o.value === w) || options.find((o) => o.label.trim() === w || o.text.trim() === w));
+      const missing = wanted.filter((w, k) => !picks[k]);
+      if (missing.length) return {error: 'no option ' + JSON.stringify(missing[0])};
+      if (!el.multiple && picks.length > 1) return {error: 'single select takes one value'};
+      el.focus();
+      options.forEach((o) => { o.selected = picks.includes(o); });
+      fire(el);
+      return {};
+    }
+    if (tag === 'INPUT' && type === 'file') return {error: 'file input: use upload_file'};
+    if (field.type || el.isContentEditable) return {typing: true};
+    if (tag !== 'INPUT' && tag !== 'TEXTAREA') return {error: 'not a form field (' + tag.toLowerCase() + ')'};
+    if (el.readOnly) return {error: 'readonly'};
+    el.focus();
+    setValue(el, String(value));
+    fire(el);
+    return {};
+  };
+  return fields.map((field) => {
+    try {
+      return fill(field, field.element >= 0 ? elements[field.element] : window.__bmcps.query(field.selector));
+    } catch (e) {
+      return {error: e.message};
+    }
+  });
+})JS";
+
+static const char kIsVisibleFunction[] = R"JS(function(selector) {
+  const el = this && this.nodeType === 1 ? this : window.__bmcps.query(selector);
+  if (!el) return false;
+  const r = el.getBoundingClientRect();
+  const style = window.getComputedStyle(el);
+  return r.width > 0 && r.height > 0 && style.visibility !== 'hidden' && style.display !== 'none';
+})JS";
+
+static const char kBoundingBoxFunction[] = R"JS(function(selector) {
+  const el = this && this.nodeType === 1 ? this : window.__bmcps.query(selector);
+  if (!el) return null;
+  const r = el.getBoundingClientRect();
+  return {x: r.x, y: r.y, width: r.width, height: r.height};
+})JS";
+
+static const char kOuterHtmlFunction[] = R"JS(function(selector) {
+  const el = this && this.nodeType === 1 ? this : window.__bmcps.query(selector);
+  return el ? el.outerHTML : null;
+})JS";
+
+static const char kScrollElementFunction[] = R"JS(function(selector, deltaX, deltaY) {
+  const el = this && this.nodeType === 1 ? this : window.__bmcps.query(selector);
+  if (!el) return false;
+  el.scrollBy(deltaX, deltaY);
+  return true;
+})JS";
+
+struct RuntimeFunction {
+    const char *name;
+    const char *source;
+};
+
+static const RuntimeFunction kRuntimeFunctions[] = {
+    {"query", kQueryFunction},
+    {"actionable", kActionableFunction},
+    {"resolvePoint", kResolvePointFunction},
+    {"interactiveIndex", kInteractiveIndexFunction},
+    {"focusField", kFocusFieldFunction},
+    {"fillForm", kFillFormFunction},
+    {"pageText", kPageTextFunction},
+    {"waitForSelector", kWaitForSelectorFunction},
+    {"isVisible", kIsVisibleFunction},
+    {"boundingBox", kBoundingBoxFunction},
+    {"scrollElement", kScrollElementFunction},
+    {"outerHtml", kOuterHtmlFunction},
+};
+
+int version() {
+    return kRuntimeVersion;
+}
+
+const std::string &install_source() {
+    static const std::string source = [] {
+        std::string version_text = std::to_string(kRuntimeVersion);
+        std::string script = "(function() {\n"
+                             "  const existing = window.__bmcps;\n"
+                             "  if (existing && existing.version === " + version_text + ") return true;\n"
+                             "  const runtime = {version: " + version_text + "};\n";
+        for (const RuntimeFunction &function : kRuntimeFunctions) {
+            script += "  runtime." + std::string(function.name) + " = " + function.source + ";\n";
+        }
+        // Not enumerable, so page scripts walking window do not trip over it.
+        script += "  Object.defineProperty(window, '__bmcps', {value: runtime, configurable: true, writable: true});\n"
+                  "  return true;\n"
+                  "})()";
+        return script;
+    }();
+    return source;
+}
+
+std::string call_declaration(const std::string &name) {
+    return "function() { const r = window.__bmcps; return r && r.version === " + std::to_string(kRuntimeVersion) +
+           " ? r." + name + ".apply(this, arguments) : '" + kMissingMarker + "'; }";
+}
+
+std::string call_expression(const std::string &name, const json &arguments) {
+    std::string expression = "(" + call_declaration(name) + ")(";
+    for (size_t index = 0; index < arguments.size(); index++) {
+        expression += (index > 0 ? "," : "") + arguments[index].dump();
+    }
+    return expression + ")";
+}
+
+bool is_missing_response(const json &response) {
+    if (!response.contains("result") || !response["result"].is_object() || !response["result"].contains("result")) {
+        return false;
+    }
+    const json &remote_object = response["result"]["result"];
+    return remote_object.is_object() && remote_object.contains("value") && remote_object["value"].is_string() &&
+           remote_object["value"].get<std::string>() == kMissingMarker;
+}
+
+} // namespace cdp_page_runtime
@@ -0,0 +1,32 @@
+#ifndef BMCPS_CDP_PAGE_RUNTIME_HPP
+#define BMCPS_CDP_PAGE_RUNTIME_HPP
+
+// The in-page helper library, window.__bmcps. It is installed once per document (through
+// Page.addScriptToEvaluateOnNewDocument, or on demand in documents that predate it), so driver
+// calls only send a short forwarder such as __bmcps.pageText(selector, cursor, maxBytes) and V8
+// compiles each helper once per document instead of once per call.
+
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace cdp_page_runtime {
+
+// Library version. A document holding another version is treated as not having the runtime.
+int version();
+
+// Script that installs window.__bmcps (a no-op when the same version is already present).
+const std::string &install_source();
+
+// Runtime.callFunctionOn declaration forwarding `this` and the arguments to __bmcps.<name>.
+// When the runtime is missing it returns a marker instead (see is_missing_response).
+std::string call_declaration(const std::string &name);
+
+// Runtime.evaluate expression calling __bmcps.<name>(arguments...).
+std::string call_expression(const std::string &name, const nlohmann::json &arguments);
+
+// True when a Runtime.callFunctionOn / evaluate response reports that the runtime was missing.
+bool is_missing_response(const nlohmann::json &response);
+
+} // namespace cdp_page_runtime
+
+#endif // BMCPS_CDP_PAGE_RUNTIME_HPP
@@ -0,0 +1,340 @@
+#include "browser/cdp/cdp_screenshot_diff.hpp"
+
+#include <zlib.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace cdp_screenshot_diff {
+
+static constexpr int kMaxDimension = 16384;
+
+bool decode_base64(const std::string &text, std::string &out_bytes) {
+    static const auto kDecodeTable = [] {
+        std::vector<int> table(256, -1);
+        const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int index = 0; index < 64; ++index) {
+            table[static_cast<unsigned char>(alphabet[index])] = index;
+        }
+        return table;
+    }();
+    out_bytes.clear();
+    out_bytes.reserve(text.size() / 4 * 3);
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for (char character : text) {
+        if (character == '=') {
+            break;
+        }
+        int value = kDecodeTable[static_cast<unsigned char>(character)];
+        if (value < 0) {
+            if (character == '\n' || character == '\r') {
+                continue;
+            }
+            return false;
+        }
+        accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out_bytes.push_back(static_cast<char>((accumulator >> bits) & 0xFF));
+        }
+    }
+    return true;
+}
+
+std::string encode_base64(const std::string &bytes) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string text;
+    text.reserve((bytes.size() + 2) / 3 * 4);
+    size_t index = 0;
+    for (; index + 2 < bytes.size(); index += 3) {
+        uint32_t group = (static_cast<uint32_t>(static_cast<unsigned char>(bytes[index])) << 16) |
+                         (static_cast<uint32_t>(static_cast<unsigned char>(bytes[index + 1])) << 8) |
+                         static_cast<uint32_t>(static_cast<unsigned char>(bytes[index + 2]));
+        text.push_back(kAlphabet[(group >> 18) & 0x3F]);
+        text.push_back(kAlphabet[(group >> 12) & 0x3F]);
+        text.push_back(kAlphabet[(group >> 6) & 0x3F]);
+        text.push_back(kAlphabet[group & 0x3F]);
+    }
+    size_t remaining = bytes.size() - index;
+    if (remaining > 0) {
+        uint32_t group = static_cast<uint32_t>(static_cast<unsigned char>(bytes[index])) << 16;
+        if (remaining == 2) {
+            group |= static_cast<uint32_t>(static_cast<unsigned char>(bytes[index + 1])) << 8;
+        }
+        text.push_back(kAlphabet[(group >> 18) & 0x3F]);
+        text.push_back(kAlphabet[(group >> 12) & 0x3F]);
+        text.push_back(remaining == 2 ? kAlphabet[(group >> 6) & 0x3F] : '=');
+        text.push_back('=');
+    }
+    return text;
+}
+
+static void append_be32(std::string &out, uint32_t value) {
+    out.push_back(static_cast<char>((value >> 24) & 0xFF));
+    out.push_back(static_cast<char>((value >> 16) & 0xFF));
+    out.push_back(static_cast<char>((value >> 8) & 0xFF));
+    out.push_back(static_cast<char>(value & 0xFF));
+}
+
+static void append_png_chunk(std::string &out, const char *type, const std::string &data) {
+    append_be32(out, static_cast<uint32_t>(data.size()));
+    size_t body_start = out.size();
+    out.append(type, 4);
+    out += data;
+    append_be32(out, static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef *>(out.data() + body_start),
+                                                 static_cast<uInt>(out.size() - body_start))));
+}
+
+static uint32_t read_be32(const unsigned char *bytes) {
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+static int paeth(int left, int up, int up_left) {
+    int estimate = left + up - up_left;
+    int distance_left = std::abs(estimate - left);
+    int distance_up = std::abs(estimate - up);
+    int distance_up_left = std::abs(estimate - up_left);
+    if (distance_left <= distance_up && distance_left <= distance_up_left) {
+        return left;
+    }
+    return distance_up <= distance_up_left ? up : up_left;
+}
+
+// Undo the per-row filter in place. previous is the unfiltered row above (zeros for the first row).
+static bool unfilter_row(int filter, unsigned char *row, const unsigned char *previous, size_t length,
+                         int bytes_per_pixel) {
+    switch (filter) {
+    case 0:
+        return true;
+    case 1:
+        for (size_t index = bytes_per_pixel; index < length; ++index) {
+            row[index] = static_cast<unsigned char>(row[index] + row[index - bytes_per_pixel]);
+        }
+        return true;
+    case 2:
+        for (size_t index = 0; index < length; ++index) {
+            row[index] = static_cast<unsigned char>(row[index] + previous[index]);
+        }
+        return true;
+    case 3:
+        for (size_t index = 0; index < length; ++index) {
+            int left = index >= static_cast<size_t>(bytes_per_pixel) ? row[index - bytes_per_pixel] : 0;
+            row[index] = static_cast<unsigned char>(row[index] + ((left + previous[index]) >> 1));
+        }
+        return true;
+    case 4:
+        for (size_t index = 0; index < length; ++index) {
+            bool has_left = index >= static_cast<size_t>(bytes_per_pixel);
+            int left = has_left ? row[index - bytes_per_pixel] : 0;
+            int up_left = has_left ? previous[index - bytes_per_pixel] : 0;
+            row[index] = static_cast<unsigned char>(row[index] + paeth(left, previous[index], up_left));
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool decode_png(const std::string &png_bytes, Image &out_image, std::string &out_error) {
+    static const unsigned char kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(png_bytes.data());
+    size_t size = png_bytes.size();
+    if (size < 8 || std::memcmp(data, kSignature, 8) != 0) {
+        out_error = "Not a PNG image.";
+        return false;
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::string compressed;
+    for (size_t offset = 8; offset + 12 <= size;) {
+        uint32_t length = read_be32(data + offset);
+        const unsigned char *type = data + offset + 4;
+        const unsigned char *chunk = data + offset + 8;
+        if (length > size - offset - 12) {
+            out_error = "Truncated PNG chunk.";
+            return false;
+        }
+        if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+            width = static_cast<int>(std::min<uint32_t>(read_be32(chunk), kMaxDimension + 1));
+            height = static_cast<int>(std::min<uint32_t>(read_be32(chunk + 4), kMaxDimension + 1));
+            int bit_depth = chunk[8];
+            int color_type = chunk[9];
+            int interlace = chunk[12];
+            channels = color_type == 0 ? 1 : color_type == 2 ? 3 : color_type == 4 ? 2 : color_type == 6 ? 4 : 0;
+            if (bit_depth != 8 || channels == 0 || interlace != 0) {
+                out_error = "Unsupported PNG format (bit depth " + std::to_string(bit_depth) + ", color type " +
+                            std::to_string(color_type) + ", interlace " + std::to_string(interlace) + ").";
+                return false;
+            }
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            compressed.append(reinterpret_cast<const char *>(chunk), length);
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        offset += 12 + static_cast<size_t>(length);
+    }
+    if (width <= 0 || height <= 0 || width > kMaxDimension || height > kMaxDimension) {
+        out_error = "Missing or invalid PNG header.";
+        return false;
+    }
+
+    size_t stride = static_cast<size_t>(width) * channels;
+    std::vector<unsigned char> raw((stride + 1) * height);
+    uLongf raw_size = static_cast<uLongf>(raw.size());
+    int inflate_status = uncompress(raw.data(), &raw_size, reinterpret_cast<const Bytef *>(compressed.data()),
+                                    static_cast<uLong>(compressed.size()));
+    if (inflate_status != Z_OK || raw_size != raw.size()) {
+        out_error = "Corrupt PNG image data.";
+        return false;
+    }
+
+    out_image.width = width;
+    out_image.height = height;
+    out_image.pixels.resize(static_cast<size_t>(width) * height);
+    std::vector<unsigned char> zero_row(stride, 0);
+    const unsigned char *previous = zero_row.data();
+    for (int y = 0; y < height; ++y) {
+        unsigned char *row = raw.data() + static_cast<size_t>(y) * (stride + 1);
+        if (!unfilter_row(row[0], row + 1, previous, stride, channels)) {
+            out_error = "Invalid PNG row filter.";
+            return false;
+        }
+        const unsigned char *source = row + 1;
+        unsigned char *target = reinterpret_cast<unsigned char *>(out_image.pixels.data() + static_cast<size_t>(y) * width);
+        for (int x = 0; x < width; ++x, source += channels, target += 4) {
+            if (channels >= 3) {
+                target[0] = source[0];
+                target[1] = source[1];
+                target[2] = source[2];
+            } else {
+                target[0] = target[1] = target[2] = source[0];
+            }
+            target[3] = channels == 4 ? source[3] : channels == 2 ? source[1] : 0xFF;
+        }
+        previous = row + 1;
+    }
+    return true;
+}
+
+std::string encode_png(const Image &image, const Region &region) {
+    int left = std::max(0, region.x);
+    int top = std::max(0, region.y);
+    int width = std::min(image.width, region.x + region.width) - left;
+    int height = std::min(image.height, region.y + region.height) - top;
+    if (width <= 0 || height <= 0) {
+        return "";
+    }
+
+    // Sub filter on every row: screenshots are mostly flat runs, which it turns into zeros.
+    size_t stride = static_cast<size_t>(width) * 4;
+    std::string raw;
+    raw.reserve((stride + 1) * height);
+    for (int y = top; y < top + height; ++y) {
+        const unsigned char *row =
+            reinterpret_cast<const unsigned char *>(image.pixels.data() + static_cast<size_t>(y) * image.width + left);
+        raw.push_back(1);
+        for (size_t index = 0; index < stride; ++index) {
+            raw.push_back(static_cast<char>(row[index] - (index >= 4 ? row[index - 4] : 0)));
+        }
+    }
+    std::string compressed(compressBound(static_cast<uLong>(raw.size())), '\0');
+    uLongf compressed_size = static_cast<uLongf>(compressed.size());
+    if (compress2(reinterpret_cast<Bytef *>(&compressed[0]), &compressed_size,
+                  reinterpret_cast<const Bytef *>(raw.data()), static_cast<uLong>(raw.size()), Z_BEST_SPEED) != Z_OK) {
+        return "";
+    }
+    compressed.resize(compressed_size);
+
+    std::string header;
+    append_be32(header, static_cast<uint32_t>(width));
+    append_be32(header, static_cast<uint32_t>(height));
+    header += std::string("\x08\x06\x00\x00\x00", 5);  // 8-bit RGBA, no interlace
+    std::string png = "\x89PNG\r\n\x1A\n";
+    append_png_chunk(png, "IHDR", header);
+    append_png_chunk(png, "IDAT", compressed);
+    append_png_chunk(png, "IEND", "");
+    return png;
+}
+
+std::vector<Region> changed_regions(const Image &previous, const Image &current, int tile_size) {
+    std::vector<Region> regions;
+    if (previous.width != current.width || previous.height != current.height || current.width <= 0 ||
+        current.height <= 0 || tile_size <= 0) {
+        return regions;
+    }
+    int width = current.width;
+    int height = current.height;
+    int tiles_x = (width + tile_size - 1) / tile_size;
+    int tiles_y = (height + tile_size - 1) / tile_size;
+
+    // Row segments are compared with memcmp (vectorized by the C library); a tile stops being
+    // compared at its first differing row.
+    std::vector<char> changed(static_cast<size_t>(tiles_x) * tiles_y, 0);
+    for (int y = 0; y < height; ++y) {
+        const uint32_t *previous_row = previous.pixels.data() + static_cast<size_t>(y) * width;
+        const uint32_t *current_row = current.pixels.data() + static_cast<size_t>(y) * width;
+        if (std::memcmp(previous_row, current_row, static_cast<size_t>(width) * sizeof(uint32_t)) == 0) {
+            continue;
+        }
+        char *tile_row = changed.data() + static_cast<size_t>(y / tile_size) * tiles_x;
+        for (int tile_x = 0; tile_x < tiles_x; ++tile_x) {
+            if (tile_row[tile_x]) {
+                continue;
+            }
+            int x = tile_x * tile_size;
+            int span = std::min(tile_size, width - x);
+            if (std::memcmp(previous_row + x, current_row + x, static_cast<size_t>(span) * sizeof(uint32_t)) != 0) {
+                tile_row[tile_x] = 1;
+            }
+        }
+    }
+
+    // Group changed tiles (8-connected flood fill) into bounding boxes.
+    std::vector<char> visited(changed.size(), 0);
+    std::vector<int> stack;
+    for (int start = 0; start < static_cast<int>(changed.size()); ++start) {
+        if (!changed[start] || visited[start]) {
+            continue;
+        }
+        int min_x = tiles_x;
+        int min_y = tiles_y;
+        int max_x = -1;
+        int max_y = -1;
+        visited[start] = 1;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int tile = stack.back();
+            stack.pop_back();
+            int tile_x = tile % tiles_x;
+            int tile_y = tile / tiles_x;
+            min_x = std::min(min_x, tile_x);
+            max_x = std::max(max_x, tile_x);
+            min_y = std::min(min_y, tile_y);
+            max_y = std::max(max_y, tile_y);
+            for (int neighbor_y = std::max(0, tile_y - 1); neighbor_y <= std::min(tiles_y - 1, tile_y + 1); ++neighbor_y) {
+                for (int neighbor_x = std::max(0, tile_x - 1); neighbor_x <= std::min(tiles_x - 1, tile_x + 1);
+                     ++neighbor_x) {
+                    int neighbor = neighbor_y * tiles_x + neighbor_x;
+                    if (changed[neighbor] && !visited[neighbor]) {
+                        visited[neighbor] = 1;
+                        stack.push_back(neighbor);
+                    }
+                }
+            }
+        }
+        Region region;
+        region.x = min_x * tile_size;
+        region.y = min_y * tile_size;
+        region.width = std::min(width, (max_x + 1) * tile_size) - region.x;
+        region.height = std::min(height, (max_y + 1) * tile_size) - region.y;
+        regions.push_back(region);
+    }
+    return regions;
+}
+
+} // namespace cdp_screenshot_diff
@@ -0,0 +1,48 @@
+#ifndef BMCPS_CDP_SCREENSHOT_DIFF_HPP
+#define BMCPS_CDP_SCREENSHOT_DIFF_HPP
+
+// Change detection between two screenshots (capture_screenshot changes_only).
+// Page.captureScreenshot PNGs are decoded to RGBA pixels and compared tile by tile;
+// changed tiles are merged into bounding boxes that are cut out of the frame as PNG crops.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cdp_screenshot_diff {
+
+// Decoded image, one RGBA pixel per uint32_t (bytes in R, G, B, A memory order), row-major.
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+};
+
+// Rectangle in image pixels.
+struct Region {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Standard base64 (as in CDP "data" fields). False on invalid characters.
+bool decode_base64(const std::string &text, std::string &out_bytes);
+
+// Standard base64 with padding.
+std::string encode_base64(const std::string &bytes);
+
+// 8-bit, non-interlaced PNG in grayscale, RGB, grayscale+alpha or RGBA (what Chrome encodes).
+bool decode_png(const std::string &png_bytes, Image &out_image, std::string &out_error);
+
+// 8-bit RGBA PNG of a rectangle of image (clamped to the image), for crops cut from the very
+// frame that was compared.
+std::string encode_png(const Image &image, const Region &region);
+
+// Bounding boxes of groups of changed tile_size x tile_size tiles (tiles touching, including
+// diagonally, form one group), in top-to-bottom order. Empty = identical. Images must have the same size.
+std::vector<Region> changed_regions(const Image &previous, const Image &current, int tile_size = 32);
+
+} // namespace cdp_screenshot_diff
+
+#endif // BMCPS_CDP_SCREENSHOT_DIFF_HPP
@@ -11,6 +11,12 @@ void register_tool(const ToolDefinition &definition) {
     registered_tools.push_back(definition);
 }
 
+void transform_tools(const std::function<void(ToolDefinition &)> &transform) {
+    for (auto &tool : registered_tools) {
+        transform(tool);
+    }
+}
+
 json build_tools_list_response() {
     json tools_array = json::array();
     for (const auto &tool : registered_tools) {
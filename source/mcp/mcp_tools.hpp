@@ -27,6 +27,9 @@ struct ToolDefinition {
 // Register a tool. Call this during initialization for each tool.
 void register_tool(const ToolDefinition &definition);
 
+// Apply transform to every registered tool (e.g. to add arguments shared by many tools).
+void transform_tools(const std::function<void(ToolDefinition &)> &transform);
+
 // Build the response payload for tools/list.
 json build_tools_list_response();
 
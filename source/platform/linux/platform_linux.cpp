@@ -61,6 +61,38 @@ bool read_file_contents(const std::string &file_path, std::string &output_conten
     return true;
 }
 
+bool write_file_contents(const std::string &file_path, const std::string &contents) {
+    std::error_code error;
+    std::filesystem::path parent_directory = std::filesystem::path(file_path).parent_path();
+    if (!parent_directory.empty()) {
+        std::filesystem::create_directories(parent_directory, error);
+    }
+    std::ofstream file_stream(file_path, std::ios::binary | std::ios::trunc);
+    if (!file_stream.is_open()) {
+        return false;
+    }
+    file_stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return static_cast<bool>(file_stream);
+}
+
+bool ensure_directory(const std::string &directory_path, std::string &output_error) {
+    std::error_code error;
+    std::filesystem::create_directories(directory_path, error);
+    if (error) {
+        output_error = "Cannot create directory " + directory_path + ": " + error.message();
+        return false;
+    }
+    if (!std::filesystem::is_directory(directory_path, error)) {
+        output_error = directory_path + " is not a directory";
+        return false;
+    }
+    if (access(directory_path.c_str(), W_OK | X_OK) != 0) {
+        output_error = "Directory " + directory_path + " is not writable: " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
 bool wait_for_file(const std::string &file_path, int timeout_milliseconds) {
     int elapsed_milliseconds = 0;
     int poll_interval_milliseconds = 100;
@@ -27,6 +27,14 @@ SpawnResult spawn_process(const std::string &executable_path,
 // Returns true on success, false on failure (file not found, permission, etc.).
 bool read_file_contents(const std::string &file_path, std::string &output_contents);
 
+// Write contents to a file (binary), creating missing parent directories. Replaces an existing file.
+// Returns true on success.
+bool write_file_contents(const std::string &file_path, const std::string &contents);
+
+// Create a directory (and missing parents) unless it exists. Returns false with the reason in
+// output_error when it cannot be created, is not a directory or is not writable.
+bool ensure_directory(const std::string &directory_path, std::string &output_error);
+
 // Wait (poll) until a file exists, up to timeout_milliseconds.
 // Returns true if the file appeared, false if timed out.
 bool wait_for_file(const std::string &file_path, int timeout_milliseconds);
@@ -9,7 +9,11 @@ using json = nlohmann::json;
 
 // Tool handler for "capture_screenshot".
 // Captures a screenshot of the currently displayed browser tab via CDP Page.captureScreenshot.
-// Default: jpeg quality 70. Caller can set format (png | jpeg) and quality. If image exceeds max payload size, a clear error is returned.
+// Default: jpeg quality 70. Caller can set format (png | jpeg | webp) and quality. If image exceeds max payload size, a clear error is returned.
+// clip / selector capture a region only; scale and max_width / max_height downsample in the browser.
+// mode=latest returns the newest frame of a screencast kept running on the tab instead of rendering anew.
+// changes_only compares with the previous changes_only capture and returns nothing or crops of changed areas.
+// full_page captures the whole page as tiles, returned in order or written to output_directory.
 
 static json handle_capture_screenshot(const json &arguments) {
     browser_driver::CaptureScreenshotOptions options;
@@ -18,7 +22,7 @@ static json handle_capture_screenshot(const json &arguments) {
 
     if (arguments.contains("format") && arguments["format"].is_string()) {
         std::string format_arg = arguments["format"].get<std::string>();
-        if (format_arg == "png" || format_arg == "jpeg") {
+        if (format_arg == "png" || format_arg == "jpeg" || format_arg == "webp") {
             options.format = format_arg;
         }
     }
@@ -28,16 +32,142 @@ static json handle_capture_screenshot(const json &arguments) {
             options.quality = quality_arg;
         }
     }
+    if (arguments.contains("clip") && arguments["clip"].is_object()) {
+        const json &clip = arguments["clip"];
+        options.clip_x = clip.contains("x") && clip["x"].is_number() ? clip["x"].get<double>() : 0.0;
+        options.clip_y = clip.contains("y") && clip["y"].is_number() ? clip["y"].get<double>() : 0.0;
+        options.clip_width = clip.contains("width") && clip["width"].is_number() ? clip["width"].get<double>() : 0.0;
+        options.clip_height =
+            clip.contains("height") && clip["height"].is_number() ? clip["height"].get<double>() : 0.0;
+    }
+    if (arguments.contains("selector") && arguments["selector"].is_string()) {
+        options.selector = arguments["selector"].get<std::string>();
+    }
+    if (arguments.contains("scale") && arguments["scale"].is_number()) {
+        options.scale = arguments["scale"].get<double>();
+    }
+    if (arguments.contains("max_width") && arguments["max_width"].is_number_integer()) {
+        options.max_width = arguments["max_width"].get<int>();
+    }
+    if (arguments.contains("max_height") && arguments["max_height"].is_number_integer()) {
+        options.max_height = arguments["max_height"].get<int>();
+    }
+    if (arguments.contains("max_bytes") && arguments["max_bytes"].is_number_integer()) {
+        options.max_bytes = arguments["max_bytes"].get<int>();
+    }
+    if (arguments.contains("mode") && arguments["mode"].is_string()) {
+        std::string mode_arg = arguments["mode"].get<std::string>();
+        if (mode_arg == "capture" || mode_arg == "latest" || mode_arg == "stop") {
+            options.mode = mode_arg;
+        }
+    }
+    if (arguments.contains("every_nth_frame") && arguments["every_nth_frame"].is_number_integer()) {
+        options.every_nth_frame = arguments["every_nth_frame"].get<int>();
+    }
+    if (arguments.contains("changes_only") && arguments["changes_only"].is_boolean()) {
+        options.changes_only = arguments["changes_only"].get<bool>();
+    }
+    if (arguments.contains("full_page") && arguments["full_page"].is_boolean()) {
+        options.full_page = arguments["full_page"].get<bool>();
+    }
+    if (arguments.contains("tile_height") && arguments["tile_height"].is_number_integer()) {
+        options.tile_height = arguments["tile_height"].get<int>();
+    }
+    if (arguments.contains("output_directory") && arguments["output_directory"].is_string()) {
+        options.output_directory = arguments["output_directory"].get<std::string>();
+    }
 
     debug_log::log("capture_screenshot invoked format=" + options.format + " quality=" + std::to_string(options.quality));
     browser_driver::CaptureScreenshotResult screenshot_result = cdp_driver::capture_screenshot(options);
 
     json result;
 
-    if (screenshot_result.success) {
+    if (screenshot_result.success && options.mode == "stop") {
+        json text_content;
+        text_content["type"] = "text";
+        text_content["text"] = "Screencast stopped.";
+
+        result["content"] = json::array({text_content});
+        result["isError"] = false;
+    } else if (screenshot_result.success && options.full_page) {
+        json content = json::array();
+        json text_content;
+        text_content["type"] = "text";
+        text_content["text"] = "Full page " + std::to_string(static_cast<int>(screenshot_result.page_width)) + "x" +
+                               std::to_string(static_cast<int>(screenshot_result.page_height)) + " CSS px in " +
+                               std::to_string(screenshot_result.tiles.size()) + " tile(s), top to bottom.";
+        if (screenshot_result.truncated) {
+            text_content["text"] = text_content["text"].get<std::string>() + " Stopped before the bottom of the page " +
+                                   "(tile or size limit); use output_directory, a larger tile_height or a lower scale.";
+        }
+        content.push_back(text_content);
+        for (const auto &tile : screenshot_result.tiles) {
+            json tile_text;
+            tile_text["type"] = "text";
+            tile_text["text"] = "Tile y=" + std::to_string(tile.y) + ".." + std::to_string(tile.y + tile.height) +
+                                (tile.file_path.empty() ? ":" : ": " + tile.file_path);
+            content.push_back(tile_text);
+            if (tile.file_path.empty()) {
+                json image_content;
+                image_content["type"] = "image";
+                image_content["data"] = tile.image_base64;
+                image_content["mimeType"] = screenshot_result.mime_type;
+                content.push_back(image_content);
+            }
+        }
+
+        result["content"] = content;
+        result["isError"] = false;
+    } else if (screenshot_result.success && screenshot_result.unchanged) {
+        json text_content;
+        text_content["type"] = "text";
+        text_content["text"] = "No visual change since the last capture.";
+
+        result["content"] = json::array({text_content});
+        result["isError"] = false;
+    } else if (screenshot_result.success && !screenshot_result.changed_regions.empty()) {
+        json content = json::array();
+        json text_content;
+        text_content["type"] = "text";
+        text_content["text"] = std::to_string(screenshot_result.changed_regions.size()) +
+                               " area(s) changed since the last capture of this " +
+                               std::to_string(screenshot_result.full_width) + "x" +
+                               std::to_string(screenshot_result.full_height) + " screenshot; crops follow.";
+        content.push_back(text_content);
+        for (const auto &region : screenshot_result.changed_regions) {
+            json region_text;
+            region_text["type"] = "text";
+            region_text["text"] = "Changed area at x=" + std::to_string(region.x) + " y=" + std::to_string(region.y) +
+                                  ", " + std::to_string(region.width) + "x" + std::to_string(region.height) + ":";
+            content.push_back(region_text);
+
+            json image_content;
+            image_content["type"] = "image";
+            image_content["data"] = region.image_base64;
+            image_content["mimeType"] = screenshot_result.mime_type;
+            content.push_back(image_content);
+        }
+
+        result["content"] = content;
+        result["isError"] = false;
+    } else if (screenshot_result.success) {
         json text_content;
         text_content["type"] = "text";
         text_content["text"] = "Screenshot captured.";
+        if (screenshot_result.adapted) {
+            std::string note = " Re-encoded as " + screenshot_result.mime_type;
+            if (screenshot_result.quality > 0) {
+                note += " quality " + std::to_string(screenshot_result.quality);
+            }
+            if (screenshot_result.scale < 1.0) {
+                note += " at " + std::to_string(static_cast<int>(screenshot_result.scale * 100 + 0.5)) + "% scale";
+            }
+            text_content["text"] = text_content["text"].get<std::string>() + note + " to fit the size limit.";
+        }
+        if (screenshot_result.from_screencast) {
+            text_content["text"] = "Latest screencast frame (page last painted " +
+                                   std::to_string(screenshot_result.frame_age_milliseconds) + " ms ago).";
+        }
 
         json image_content;
         image_content["type"] = "image";
@@ -66,20 +196,86 @@ void register_tool() {
     input_schema["properties"] = json::object();
     input_schema["properties"]["format"] = {
         {"type", "string"},
-        {"enum", json::array({"png", "jpeg"})},
-        {"description", "Image format: jpeg (default) or png. Caller chooses."}
+        {"enum", json::array({"png", "jpeg", "webp"})},
+        {"description", "Image format: jpeg (default), png or webp (about half the size of jpeg)."}
     };
     input_schema["properties"]["quality"] = {
         {"type", "integer"},
-        {"description", "JPEG quality 1–100 (default 70). Only used when format is jpeg. Lower = smaller file."}
+        {"description", "JPEG/WebP quality 1–100 (default 70). Not used for png. Lower = smaller file."}
+    };
+    input_schema["properties"]["clip"] = {
+        {"type", "object"},
+        {"properties", {{"x", {{"type", "number"}}}, {"y", {{"type", "number"}}},
+                        {"width", {{"type", "number"}}}, {"height", {{"type", "number"}}}}},
+        {"description", "Optional. Region to capture in CSS pixels from the viewport's top-left."}
+    };
+    input_schema["properties"]["selector"] = {
+        {"type", "string"},
+        {"description", "Optional. Selector or element handle; captures only this element (scrolled into view). "
+                        "Overrides clip."}
+    };
+    input_schema["properties"]["scale"] = {
+        {"type", "number"},
+        {"description", "Optional. Downscale factor between 0 and 1 (default 1), e.g. 0.5 for half size."}
+    };
+    input_schema["properties"]["max_width"] = {
+        {"type", "integer"},
+        {"description", "Optional. Maximum image width in pixels; the capture is downscaled to fit."}
+    };
+    input_schema["properties"]["max_height"] = {
+        {"type", "integer"},
+        {"description", "Optional. Maximum image height in pixels; the capture is downscaled to fit."}
+    };
+    input_schema["properties"]["max_bytes"] = {
+        {"type", "integer"},
+        {"description", "Optional. Target payload size in base64 bytes (default and upper bound: the configured "
+                        "max size). Larger captures are re-encoded (png as webp, lower quality, then downscaled)."}
+    };
+    input_schema["properties"]["mode"] = {
+        {"type", "string"},
+        {"enum", json::array({"capture", "latest", "stop"})},
+        {"description", "Optional. capture (default): render a new screenshot. latest: newest frame of a "
+                        "screencast kept running on the tab (started on first use with format, quality and "
+                        "max_width/max_height; png or jpeg), returned without a render round trip. stop: stop "
+                        "the screencast."}
+    };
+    input_schema["properties"]["every_nth_frame"] = {
+        {"type", "integer"},
+        {"description", "Optional. mode=latest: let the screencast send every n-th frame (default 6)."}
+    };
+    input_schema["properties"]["changes_only"] = {
+        {"type", "boolean"},
+        {"description", "Optional. Compare with the previous changes_only capture of this tab (same clip/selector "
+                        "and size): returns \"no visual change\", or only PNG crops of the changed areas with their "
+                        "positions. The first capture and large changes return the full image."}
+    };
+    input_schema["properties"]["full_page"] = {
+        {"type", "boolean"},
+        {"description", "Optional. Capture the whole scrollable page as tiles (top to bottom) in one call instead "
+                        "of scrolling and capturing repeatedly. format, quality, scale and max_width apply per tile."}
+    };
+    input_schema["properties"]["tile_height"] = {
+        {"type", "integer"},
+        {"description", "Optional. full_page: tile height in CSS pixels (default: the viewport height)."}
+    };
+    input_schema["properties"]["output_directory"] = {
+        {"type", "string"},
+        {"description", "Optional. full_page: write the tiles as files (page_<time>_000.jpg, ...) to this directory and "
+                        "return their paths instead of the images. Not limited by max_bytes."}
     };
     input_schema["required"] = json::array();
 
     mcp_tools::register_tool({
         "capture_screenshot",
         "Capture a screenshot of the currently displayed browser tab. "
-        "Default: jpeg quality 70. Optional: format (png | jpeg), quality (1–100 for jpeg). "
-        "If the image exceeds the configured max size, a clear error is returned (reduce viewport or lower quality). "
+        "Default: jpeg quality 70. Optional: format (png | jpeg | webp), quality (1–100 for jpeg/webp). "
+        "Capture only a region (clip) or one element (selector), and downscale with scale or max_width/max_height: "
+        "smaller images are faster to produce and transfer. "
+        "mode=latest returns the last screencast frame immediately, for screenshots after every step. "
+        "changes_only returns only what changed since the previous changes_only capture. "
+        "full_page captures the whole page as tiles (returned, or written to output_directory). "
+        "Images over max_bytes or the configured max size are re-encoded smaller to fit; an error is returned only "
+        "if that fails. "
         "Browser must be open and a tab attached (call open_browser first). "
         "Returns the screenshot as image content so the model can verify the visible UI.",
         input_schema,
@@ -22,8 +22,13 @@ static json handle_click_element(const json &arguments) {
 
     std::string selector = arguments["selector"].get<std::string>();
 
+    int timeout_milliseconds = 0;
+    if (arguments.contains("timeout_milliseconds") && arguments["timeout_milliseconds"].is_number_integer()) {
+        timeout_milliseconds = arguments["timeout_milliseconds"].get<int>();
+    }
+
     debug_log::log("click_element invoked selector=" + selector);
-    browser_driver::DriverResult click_result = cdp_driver::click_element(selector);
+    browser_driver::DriverResult click_result = cdp_driver::click_element(selector, timeout_milliseconds);
 
     if (!click_result.success) {
         json error_content;
@@ -50,7 +55,8 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = {
-        {"selector", {{"type", "string"}, {"description", "CSS selector (e.g. from list_interactive_elements)."}}}
+        {"selector", {{"type", "string"}, {"description", "Selector (CSS, text=, role=, xpath=, >>> into shadow DOM) or element handle from list_interactive_elements."}}},
+        {"timeout_milliseconds", {{"type", "integer"}, {"description", "Optional. Wait up to this long for the element to be actionable (attached, visible, stable, enabled, not covered); default 0 = act on the current state."}}}
     };
     input_schema["required"] = json::array({"selector"});
 
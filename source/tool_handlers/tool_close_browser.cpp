@@ -8,14 +8,21 @@
 using json = nlohmann::json;
 
 static json handle_close_browser(const json &arguments) {
-    (void)arguments;
-
-    debug_log::log("close_browser invoked");
-    cdp_driver::disconnect();
+    bool only_current = false;
+    if (arguments.contains("only_current") && arguments["only_current"].is_boolean()) {
+        only_current = arguments["only_current"].get<bool>();
+    }
 
+    debug_log::log(std::string("close_browser invoked, only_current=") + (only_current ? "true" : "false"));
     json text_content;
     text_content["type"] = "text";
-    text_content["text"] = "Browser closed.";
+    if (only_current) {
+        cdp_driver::disconnect_current_browser();
+        text_content["text"] = "Browser closed. Browsers still open: " + std::to_string(cdp_driver::browser_pool_size()) + ".";
+    } else {
+        cdp_driver::disconnect();
+        text_content["text"] = "Browser closed.";
+    }
 
     json result;
     result["content"] = json::array({text_content});
@@ -29,6 +36,10 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = json::object();
+    input_schema["properties"]["only_current"] = {
+        {"type", "boolean"},
+        {"description", "If true, close only the active browser of the pool (see open_browser new_instance). Default false: close all."}
+    };
 
     mcp_tools::register_tool({
         "close_browser",
@@ -0,0 +1,49 @@
+#include "tool_handlers/tool_handlers.hpp"
+#include "mcp/mcp_tools.hpp"
+#include "browser/cdp/cdp_driver.hpp"
+#include "utils/debug_log.hpp"
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+static json handle_create_browser_context(const json &arguments) {
+    (void)arguments;
+
+    debug_log::log("create_browser_context invoked");
+    browser_driver::CreateBrowserContextResult driver_result = cdp_driver::create_browser_context();
+
+    json text_content;
+    text_content["type"] = "text";
+    text_content["text"] = driver_result.message;
+
+    json result;
+    result["content"] = json::array({text_content});
+    result["isError"] = !driver_result.success;
+    if (!driver_result.success && !driver_result.error_detail.empty()) {
+        json detail_content;
+        detail_content["type"] = "text";
+        detail_content["text"] = "Detail: " + driver_result.error_detail;
+        result["content"].push_back(detail_content);
+    }
+    return result;
+}
+
+namespace tool_create_browser_context {
+
+void register_tool() {
+    json input_schema;
+    input_schema["type"] = "object";
+    input_schema["properties"] = json::object();
+
+    mcp_tools::register_tool({
+        "create_browser_context",
+        "Create an isolated browser context (own cookies, storage and cache, like an incognito profile) "
+        "in the running browser. Returns its browser_context_id; open tabs in it with new_tab. "
+        "Much faster than close_browser + open_browser for a clean state. Call open_browser first.",
+        input_schema,
+        handle_create_browser_context
+    });
+}
+
+} // namespace tool_create_browser_context
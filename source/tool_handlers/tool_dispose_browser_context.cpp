@@ -0,0 +1,65 @@
+#include "tool_handlers/tool_handlers.hpp"
+#include "mcp/mcp_tools.hpp"
+#include "browser/cdp/cdp_driver.hpp"
+#include "utils/debug_log.hpp"
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+static json handle_dispose_browser_context(const json &arguments) {
+    json result;
+
+    if (!arguments.contains("browser_context_id") || !arguments["browser_context_id"].is_string()) {
+        json error_content;
+        error_content["type"] = "text";
+        error_content["text"] = "dispose_browser_context requires a string 'browser_context_id' (from create_browser_context).";
+
+        result["content"] = json::array({error_content});
+        result["isError"] = true;
+        return result;
+    }
+
+    std::string browser_context_id = arguments["browser_context_id"].get<std::string>();
+
+    debug_log::log("dispose_browser_context invoked, browser_context_id=" + browser_context_id);
+    browser_driver::DriverResult driver_result = cdp_driver::dispose_browser_context(browser_context_id);
+
+    json text_content;
+    text_content["type"] = "text";
+    text_content["text"] = driver_result.message;
+
+    result["content"] = json::array({text_content});
+    result["isError"] = !driver_result.success;
+    if (!driver_result.success && !driver_result.error_detail.empty()) {
+        json detail_content;
+        detail_content["type"] = "text";
+        detail_content["text"] = "Detail: " + driver_result.error_detail;
+        result["content"].push_back(detail_content);
+    }
+    return result;
+}
+
+namespace tool_dispose_browser_context {
+
+void register_tool() {
+    json input_schema;
+    input_schema["type"] = "object";
+    input_schema["properties"] = json::object();
+    input_schema["properties"]["browser_context_id"] = {
+        {"type", "string"},
+        {"description", "Id returned by create_browser_context"}
+    };
+    input_schema["required"] = json::array({"browser_context_id"});
+
+    mcp_tools::register_tool({
+        "dispose_browser_context",
+        "Dispose an isolated browser context created with create_browser_context. "
+        "Closes its tabs and discards its cookies and storage. If the current tab was in it, "
+        "the first remaining tab becomes current.",
+        input_schema,
+        handle_dispose_browser_context
+    });
+}
+
+} // namespace tool_dispose_browser_context
@@ -32,8 +32,14 @@ static json handle_drag_and_drop(const json &arguments) {
     std::string source_selector = arguments["source_selector"].get<std::string>();
     std::string target_selector = arguments["target_selector"].get<std::string>();
 
+    int timeout_milliseconds = 0;
+    if (arguments.contains("timeout_milliseconds") && arguments["timeout_milliseconds"].is_number_integer()) {
+        timeout_milliseconds = arguments["timeout_milliseconds"].get<int>();
+    }
+
     debug_log::log("drag_and_drop invoked");
-    browser_driver::DriverResult drag_result = cdp_driver::drag_and_drop_selectors(source_selector, target_selector);
+    browser_driver::DriverResult drag_result =
+        cdp_driver::drag_and_drop_selectors(source_selector, target_selector, timeout_milliseconds);
 
     if (!drag_result.success) {
         json error_content;
@@ -60,8 +66,9 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = {
-        {"source_selector", {{"type", "string"}, {"description", "CSS selector of the element to drag."}}},
-        {"target_selector", {{"type", "string"}, {"description", "CSS selector of the drop target."}}}
+        {"source_selector", {{"type", "string"}, {"description", "Selector or element handle of the element to drag."}}},
+        {"target_selector", {{"type", "string"}, {"description", "Selector or element handle of the drop target."}}},
+        {"timeout_milliseconds", {{"type", "integer"}, {"description", "Optional. Wait up to this long for both elements to be actionable (attached, visible, stable, not covered); default 0 = act on the current state."}}}
     };
     input_schema["required"] = json::array({"source_selector", "target_selector"});
 
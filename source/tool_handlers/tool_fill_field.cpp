@@ -33,8 +33,13 @@ static json handle_fill_field(const json &arguments) {
     std::string value = arguments["value"].is_string() ? arguments["value"].get<std::string>() : arguments["value"].dump();
     bool clear_first = arguments.value("clear_first", true);
 
+    int timeout_milliseconds = 0;
+    if (arguments.contains("timeout_milliseconds") && arguments["timeout_milliseconds"].is_number_integer()) {
+        timeout_milliseconds = arguments["timeout_milliseconds"].get<int>();
+    }
+
     debug_log::log("fill_field invoked selector=" + selector);
-    browser_driver::DriverResult fill_result = cdp_driver::fill_field(selector, value, clear_first);
+    browser_driver::DriverResult fill_result = cdp_driver::fill_field(selector, value, clear_first, timeout_milliseconds);
 
     if (!fill_result.success) {
         json error_content;
@@ -61,9 +66,10 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = {
-        {"selector", {{"type", "string"}, {"description", "CSS selector (e.g. from list_interactive_elements)."}}},
+        {"selector", {{"type", "string"}, {"description", "Selector (CSS, text=, role=, xpath=, >>> into shadow DOM) or element handle from list_interactive_elements."}}},
         {"value", {{"type", "string"}, {"description", "Text to type into the field."}}},
-        {"clear_first", {{"type", "boolean"}, {"description", "Clear the field before typing. Default true."}, {"default", true}}}
+        {"clear_first", {{"type", "boolean"}, {"description", "Clear the field before typing. Default true."}, {"default", true}}},
+        {"timeout_milliseconds", {{"type", "integer"}, {"description", "Optional. Wait up to this long for the element to be actionable (attached, visible, enabled, editable); default 0 = act on the current state."}}}
     };
     input_schema["required"] = json::array({"selector", "value"});
 
@@ -0,0 +1,118 @@
+#include "tool_handlers/tool_handlers.hpp"
+#include "mcp/mcp_tools.hpp"
+#include "browser/cdp/cdp_driver.hpp"
+#include "utils/debug_log.hpp"
+
+#include <nlohmann/json.hpp>
+#include <sstream>
+
+using json = nlohmann::json;
+
+// Field value from JSON: booleans set checkboxes/radios, arrays pick multi-select options,
+// anything else is used as text.
+static browser_driver::FormField make_field(const std::string &selector, const json &value) {
+    browser_driver::FormField field;
+    field.selector = selector;
+    if (value.is_boolean()) {
+        field.is_boolean = true;
+        field.checked = value.get<bool>();
+    } else if (value.is_array()) {
+        for (const auto &option : value) {
+            field.values.push_back(option.is_string() ? option.get<std::string>() : option.dump());
+        }
+    } else if (value.is_string()) {
+        field.value = value.get<std::string>();
+    } else if (!value.is_null()) {
+        field.value = value.dump();
+    }
+    return field;
+}
+
+static json handle_fill_form(const json &arguments) {
+    json result;
+
+    std::vector<browser_driver::FormField> fields;
+    const json &fields_argument = arguments.contains("fields") ? arguments["fields"] : json();
+    if (fields_argument.is_object()) {
+        for (auto entry = fields_argument.begin(); entry != fields_argument.end(); ++entry) {
+            fields.push_back(make_field(entry.key(), entry.value()));
+        }
+    } else if (fields_argument.is_array()) {
+        for (const auto &entry : fields_argument) {
+            if (!entry.is_object() || !entry.contains("selector") || !entry["selector"].is_string()) {
+                continue;
+            }
+            browser_driver::FormField field =
+                make_field(entry["selector"].get<std::string>(), entry.contains("value") ? entry["value"] : json());
+            field.type_text = entry.value("type", false);
+            fields.push_back(field);
+        }
+    }
+    if (fields.empty()) {
+        json error_content;
+        error_content["type"] = "text";
+        error_content["text"] = "fill_form requires 'fields': an object of selector -> value, or an array of "
+                                "{selector, value, type}.";
+
+        result["content"] = json::array({error_content});
+        result["isError"] = true;
+        return result;
+    }
+
+    debug_log::log("fill_form invoked fields=" + std::to_string(fields.size()));
+    browser_driver::FillFormResult fill_result = cdp_driver::fill_form(fields);
+
+    if (!fill_result.success) {
+        json error_content;
+        error_content["type"] = "text";
+        error_content["text"] = "fill_form failed: " + fill_result.error_detail;
+
+        result["content"] = json::array({error_content});
+        result["isError"] = true;
+        return result;
+    }
+
+    std::ostringstream text_stream;
+    text_stream << "Filled " << fill_result.filled_count << " of " << fill_result.fields.size() << " fields.";
+    for (const auto &field_result : fill_result.fields) {
+        if (!field_result.success) {
+            text_stream << "\n- " << field_result.selector << ": " << field_result.error_detail;
+        }
+    }
+
+    json text_content;
+    text_content["type"] = "text";
+    text_content["text"] = text_stream.str();
+
+    result["content"] = json::array({text_content});
+    result["isError"] = fill_result.filled_count < static_cast<int>(fill_result.fields.size());
+    return result;
+}
+
+namespace tool_fill_form {
+
+void register_tool() {
+    json input_schema;
+    input_schema["type"] = "object";
+    input_schema["properties"] = json::object();
+    input_schema["properties"]["fields"] = {
+        {"type", {"object", "array"}},
+        {"description", "Object mapping selector (or element handle) -> value, or an array of "
+                        "{selector, value, type} when the order matters (object keys are filled in sorted order). "
+                        "value: text; true/false for a checkbox or radio; the value or label of a select option; "
+                        "an array for a multi-select. type: true to type the text with real key input."}
+    };
+    input_schema["required"] = json::array({"fields"});
+
+    mcp_tools::register_tool({
+        "fill_form",
+        "Fill many form fields in one call: inputs and textareas (value set with input/change events), "
+        "checkboxes, radios and selects. Fields are resolved and filled in one page call; only contenteditable "
+        "fields or fields with type=true are typed. Reports fields that could not be filled. Browser must be "
+        "open and a tab attached.",
+        input_schema,
+        handle_fill_form
+    });
+}
+
+} // namespace tool_fill_form
@@ -0,0 +1,90 @@
+#include "tool_handlers/tool_handlers.hpp"
+#include "mcp/mcp_tools.hpp"
+#include "browser/cdp/cdp_driver.hpp"
+#include "utils/debug_log.hpp"
+
+#include <nlohmann/json.hpp>
+#include <sstream>
+
+using json = nlohmann::json;
+
+static json handle_get_accessibility_tree(const json &arguments) {
+    json result;
+
+    std::string selector;
+    if (arguments.contains("selector") && arguments["selector"].is_string()) {
+        selector = arguments["selector"].get<std::string>();
+    }
+    bool viewport_only = false;
+    if (arguments.contains("viewport_only") && arguments["viewport_only"].is_boolean()) {
+        viewport_only = arguments["viewport_only"].get<bool>();
+    }
+    int max_lines = 0;
+    if (arguments.contains("max_lines") && arguments["max_lines"].is_number_integer()) {
+        max_lines = arguments["max_lines"].get<int>();
+    }
+
+    debug_log::log("get_accessibility_tree invoked selector=" + selector);
+    browser_driver::GetAccessibilityTreeResult tree_result =
+        cdp_driver::get_accessibility_tree(selector, viewport_only, max_lines);
+
+    if (!tree_result.success) {
+        json error_content;
+        error_content["type"] = "text";
+        error_content["text"] = "get_accessibility_tree failed: " + tree_result.error_detail;
+
+        result["content"] = json::array({error_content});
+        result["isError"] = true;
+        return result;
+    }
+
+    std::ostringstream text_stream;
+    text_stream << tree_result.outline;
+    if (tree_result.line_count == 0) {
+        text_stream << (viewport_only ? "(Nothing in the viewport.)" : "(No accessible content.)");
+    }
+    if (tree_result.truncated) {
+        text_stream << "(Stopped at " << tree_result.line_count
+                    << " lines; pass a selector or viewport_only to narrow the tree.)";
+    }
+
+    json text_content;
+    text_content["type"] = "text";
+    text_content["text"] = text_stream.str();
+
+    result["content"] = json::array({text_content});
+    result["isError"] = false;
+    return result;
+}
+
+namespace tool_get_accessibility_tree {
+
+void register_tool() {
+    json input_schema;
+    input_schema["type"] = "object";
+    input_schema["properties"] = json::object();
+    input_schema["properties"]["selector"] = {
+        {"type", "string"},
+        {"description", "Optional. Selector or element handle; only this element's subtree is returned."}
+    };
+    input_schema["properties"]["viewport_only"] = {
+        {"type", "boolean"},
+        {"description", "Optional. Only nodes currently visible in the viewport (and their ancestors)."}
+    };
+    input_schema["properties"]["max_lines"] = {
+        {"type", "integer"},
+        {"description", "Optional. Maximum outline lines (default 2000)."}
+    };
+
+    mcp_tools::register_tool({
+        "get_accessibility_tree",
+        "Get a compact outline of the page's accessibility tree: one line per node with role, name, states "
+        "(checked, expanded, disabled, ...) and a handle (e.g. @n42) for interactive nodes, indented by nesting. "
+        "Ignored nodes and unnamed containers are pruned. Much smaller than get_page_source; handles work as "
+        "selector for click_element, fill_field and the other element tools. Browser must be open and a tab attached.",
+        input_schema,
+        handle_get_accessibility_tree
+    });
+}
+
+} // namespace tool_get_accessibility_tree
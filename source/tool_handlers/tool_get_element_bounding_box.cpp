@@ -55,7 +55,7 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = {
-        {"selector", {{"type", "string"}, {"description", "CSS selector of the element."}}}
+        {"selector", {{"type", "string"}, {"description", "Selector or element handle of the element."}}}
     };
     input_schema["required"] = json::array({"selector"});
 
@@ -0,0 +1,98 @@
+#include "tool_handlers/tool_handlers.hpp"
+#include "mcp/mcp_tools.hpp"
+#include "browser/cdp/cdp_driver.hpp"
+#include "utils/debug_log.hpp"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <sstream>
+
+using json = nlohmann::json;
+
+static constexpr int kDefaultMaxBytes = 16000;
+static constexpr int kMinMaxBytes = 256;
+static constexpr int kMaxMaxBytes = 1000000;
+static constexpr int kBytesPerToken = 4;  // rough average for English text
+
+static json handle_get_page_text(const json &arguments) {
+    json result;
+
+    std::string selector;
+    if (arguments.contains("selector") && arguments["selector"].is_string()) {
+        selector = arguments["selector"].get<std::string>();
+    }
+    int cursor = 0;
+    if (arguments.contains("cursor") && arguments["cursor"].is_number_integer()) {
+        cursor = std::max(0, arguments["cursor"].get<int>());
+    }
+    int max_bytes = kDefaultMaxBytes;
+    if (arguments.contains("max_bytes") && arguments["max_bytes"].is_number_integer()) {
+        max_bytes = arguments["max_bytes"].get<int>();
+    } else if (arguments.contains("max_tokens") && arguments["max_tokens"].is_number_integer()) {
+        max_bytes = arguments["max_tokens"].get<int>() * kBytesPerToken;
+    }
+    max_bytes = std::min(std::max(max_bytes, kMinMaxBytes), kMaxMaxBytes);
+
+    debug_log::log("get_page_text invoked selector=" + selector + " cursor=" + std::to_string(cursor));
+    browser_driver::GetPageTextResult text_result = cdp_driver::get_page_text(selector, cursor, max_bytes);
+
+    if (!text_result.success) {
+        json error_content;
+        error_content["type"] = "text";
+        error_content["text"] = "get_page_text failed: " + text_result.error_detail;
+
+        result["content"] = json::array({error_content});
+        result["isError"] = true;
+        return result;
+    }
+
+    std::ostringstream text_stream;
+    text_stream << text_result.text;
+    if (text_result.next_cursor >= 0) {
+        text_stream << "\n\n(Text continues: next_cursor " << text_result.next_cursor << " of "
+                    << text_result.total_length << ".)";
+    }
+
+    json text_content;
+    text_content["type"] = "text";
+    text_content["text"] = text_stream.str();
+
+    result["content"] = json::array({text_content});
+    result["isError"] = false;
+    return result;
+}
+
+namespace tool_get_page_text {
+
+void register_tool() {
+    json input_schema;
+    input_schema["type"] = "object";
+    input_schema["properties"] = json::object();
+    input_schema["properties"]["selector"] = {
+        {"type", "string"},
+        {"description", "Optional. Selector or element handle; only this element's text. Default: the page body."}
+    };
+    input_schema["properties"]["max_bytes"] = {
+        {"type", "integer"},
+        {"description", "Optional. Maximum UTF-8 bytes returned per call (default 16000)."}
+    };
+    input_schema["properties"]["max_tokens"] = {
+        {"type", "integer"},
+        {"description", "Optional. Budget in tokens instead of bytes (about 4 bytes per token)."}
+    };
+    input_schema["properties"]["cursor"] = {
+        {"type", "integer"},
+        {"description", "Optional. Continue from the next_cursor of a previous call (default 0 = start)."}
+    };
+
+    mcp_tools::register_tool({
+        "get_page_text",
+        "Get the readable text of the current page as markdown (headings, paragraphs, lists, links, code, tables), "
+        "without scripts, styles or hidden content. Returns at most max_bytes; pass next_cursor to read on. "
+        "Far smaller than get_page_source. Browser must be open and a tab attached.",
+        input_schema,
+        handle_get_page_text
+    });
+}
+
+} // namespace tool_get_page_text
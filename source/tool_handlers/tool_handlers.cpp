@@ -55,6 +55,13 @@ namespace tool_set_geolocation { void register_tool(); }
 namespace tool_set_user_agent { void register_tool(); }
 namespace tool_is_visible { void register_tool(); }
 namespace tool_get_element_bounding_box { void register_tool(); }
+namespace tool_get_accessibility_tree { void register_tool(); }
+namespace tool_get_page_text { void register_tool(); }
+namespace tool_wait_for_network_idle { void register_tool(); }
+namespace tool_fill_form { void register_tool(); }
+namespace tool_create_browser_context { void register_tool(); }
+namespace tool_dispose_browser_context { void register_tool(); }
+namespace tool_tab_routing { void apply_to_registered_tools(); }
 
 namespace tool_handlers {
 
@@ -65,6 +72,8 @@ void register_all_tools() {
     tool_new_tab::register_tool();
     tool_switch_tab::register_tool();
     tool_close_tab::register_tool();
+    tool_create_browser_context::register_tool();
+    tool_dispose_browser_context::register_tool();
     tool_navigate::register_tool();
     tool_navigate_back::register_tool();
     tool_navigate_forward::register_tool();
@@ -113,6 +122,13 @@ void register_all_tools() {
     tool_set_user_agent::register_tool();
     tool_is_visible::register_tool();
     tool_get_element_bounding_box::register_tool();
+    tool_get_accessibility_tree::register_tool();
+    tool_get_page_text::register_tool();
+    tool_wait_for_network_idle::register_tool();
+    tool_fill_form::register_tool();
+
+    // Must run last: adds tab_id/target_id to the tools registered above.
+    tool_tab_routing::apply_to_registered_tools();
 }
 
 } // namespace tool_handlers
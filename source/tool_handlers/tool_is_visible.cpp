@@ -51,7 +51,7 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = {
-        {"selector", {{"type", "string"}, {"description", "CSS selector."}}}
+        {"selector", {{"type", "string"}, {"description", "Selector or element handle."}}}
     };
     input_schema["required"] = json::array({"selector"});
 
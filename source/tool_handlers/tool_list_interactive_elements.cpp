@@ -4,15 +4,34 @@
 #include "utils/debug_log.hpp"
 
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <sstream>
 
 using json = nlohmann::json;
 
 static json handle_list_interactive_elements(const json &arguments) {
-    (void)arguments;
+    std::string since_token;
+    if (arguments.contains("since") && arguments["since"].is_string()) {
+        since_token = arguments["since"].get<std::string>();
+    }
+
+    // cursor / viewport_only select the DOMSnapshot listing (every element, paged).
+    bool snapshot_listing = false;
+    int cursor = 0;
+    if (arguments.contains("cursor") && arguments["cursor"].is_number_integer()) {
+        snapshot_listing = true;
+        cursor = std::max(0, arguments["cursor"].get<int>());
+    }
+    bool viewport_only = false;
+    if (arguments.contains("viewport_only") && arguments["viewport_only"].is_boolean()) {
+        viewport_only = arguments["viewport_only"].get<bool>();
+        snapshot_listing = snapshot_listing || viewport_only;
+    }
 
     debug_log::log("list_interactive_elements invoked");
-    browser_driver::ListInteractiveElementsResult list_result = cdp_driver::list_interactive_elements();
+    browser_driver::ListInteractiveElementsResult list_result =
+        snapshot_listing ? cdp_driver::list_interactive_elements_snapshot(cursor, viewport_only)
+                         : cdp_driver::list_interactive_elements(since_token);
 
     json result;
 
@@ -39,8 +58,44 @@ static json handle_list_interactive_elements(const json &arguments) {
     }
 
     std::ostringstream text_stream;
-    text_stream << "Found " << list_result.elements.size() << " interactive element(s):\n";
-    text_stream << elements_array.dump(2);
+    if (snapshot_listing) {
+        text_stream << "Elements " << cursor << "-" << (cursor + static_cast<int>(list_result.elements.size()))
+                    << " of " << list_result.total_count << (viewport_only ? " in the viewport" : "") << ":\n";
+        text_stream << elements_array.dump(2) << "\n";
+        if (list_result.next_cursor >= 0) {
+            text_stream << "next_cursor: " << list_result.next_cursor;
+        } else {
+            text_stream << "(Last page.)";
+        }
+
+        json text_content;
+        text_content["type"] = "text";
+        text_content["text"] = text_stream.str();
+        result["content"] = json::array({text_content});
+        result["isError"] = false;
+        return result;
+    }
+    if (list_result.is_delta) {
+        if (list_result.elements.empty() && list_result.removed_selectors.empty()) {
+            text_stream << "No changes since " << since_token << ".\n";
+        } else {
+            text_stream << list_result.elements.size() << " new or changed interactive element(s):\n";
+            text_stream << elements_array.dump(2) << "\n";
+        }
+        if (!list_result.removed_selectors.empty()) {
+            text_stream << "Removed or hidden: " << json(list_result.removed_selectors).dump() << "\n";
+        }
+    } else {
+        if (!since_token.empty()) {
+            text_stream << "The page was reloaded or the token is too old; full listing follows.\n";
+        }
+        text_stream << "Found " << list_result.elements.size() << " interactive element(s):\n";
+        text_stream << elements_array.dump(2) << "\n";
+    }
+    if (list_result.truncated) {
+        text_stream << "(More elements not shown; pass cursor 0 to page through all of them.)\n";
+    }
+    text_stream << "version: " << list_result.version_token;
 
     json text_content;
     text_content["type"] = "text";
@@ -57,12 +112,29 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = json::object();
+    input_schema["properties"]["since"] = {
+        {"type", "string"},
+        {"description", "Optional. The version from a previous call; only elements added or changed since then "
+                        "and removed handles are returned."}
+    };
+    input_schema["properties"]["cursor"] = {
+        {"type", "integer"},
+        {"description", "Optional. List every element from one DOM snapshot, 200 per page: 0 for the first page, "
+                        "then the returned next_cursor."}
+    };
+    input_schema["properties"]["viewport_only"] = {
+        {"type", "boolean"},
+        {"description", "Optional. Snapshot listing of only the elements currently in the viewport."}
+    };
     input_schema["required"] = json::array();
 
     mcp_tools::register_tool({
         "list_interactive_elements",
         "List form fields and clickable elements on the current page (inputs, textareas, buttons, links). "
-        "Returns selector, role, label, placeholder, type, and visible text for each. Use these selectors with fill_field and click_element. Browser must be open and a tab attached.",
+        "Returns a handle (e.g. @3:0) as selector, role, label, placeholder, type, and visible text for each. "
+        "Pass the handle as selector to click_element, fill_field, hover_element, upload_file and the other element tools. "
+        "Handles stay valid while the element is on the page and are stale after removal or navigation (a clear error is returned). "
+        "Pass the returned version as since to get only changes. Browser must be open and a tab attached.",
         input_schema,
         handle_list_interactive_elements
     });
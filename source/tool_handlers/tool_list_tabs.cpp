@@ -37,6 +37,8 @@ static json handle_list_tabs(const json &arguments) {
         tab_entry["title"] = tab.title;
         tab_entry["url"] = tab.url;
         tab_entry["type"] = tab.type;
+        tab_entry["browser_context_id"] = tab.browser_context_id;
+        tab_entry["browser_index"] = tab.browser_index;
         tab_entry["is_current"] = tab.is_current;
         tabs_array.push_back(tab_entry);
     }
@@ -49,7 +51,14 @@ static json handle_list_tabs(const json &arguments) {
         summary_stream << "  [" << index << "] " << tab.title
                        << " (" << tab.url << ") type=" << tab.type
                        << (tab.is_current ? " [current]" : "")
-                       << " id=" << tab.target_id << "\n";
+                       << " id=" << tab.target_id;
+        if (tab.browser_index > 0) {
+            summary_stream << " browser=" << tab.browser_index;
+        }
+        if (!tab.browser_context_id.empty()) {
+            summary_stream << " context=" << tab.browser_context_id;
+        }
+        summary_stream << "\n";
     }
 
     json text_content;
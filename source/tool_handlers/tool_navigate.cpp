@@ -24,10 +24,18 @@ static json handle_navigate(const json &arguments) {
     }
 
     std::string url = arguments["url"].get<std::string>();
+    std::string wait_until;
+    if (arguments.contains("wait_until") && arguments["wait_until"].is_string()) {
+        wait_until = arguments["wait_until"].get<std::string>();
+    }
+    int timeout_milliseconds = 30000;
+    if (arguments.contains("timeout_milliseconds") && arguments["timeout_milliseconds"].is_number_integer()) {
+        timeout_milliseconds = arguments["timeout_milliseconds"].get<int>();
+    }
 
     debug_log::log("navigate invoked");
     debug_log::log("Navigating to URL: " + url);
-    browser_driver::NavigateResult navigate_result = cdp_driver::navigate(url);
+    browser_driver::NavigateResult navigate_result = cdp_driver::navigate(url, wait_until, timeout_milliseconds);
 
     json text_content;
     text_content["type"] = "text";
@@ -36,6 +44,10 @@ static json handle_navigate(const json &arguments) {
 
     if (navigate_result.success) {
         text_content["text"] = "Navigated to " + url;
+        if (!navigate_result.reached.empty()) {
+            text_content["text"] = "Navigated to " + url + " (" + navigate_result.reached + " after " +
+                                   std::to_string(navigate_result.elapsed_milliseconds) + " ms)";
+        }
         result["isError"] = false;
     } else {
         text_content["text"] = "Navigation failed: " + navigate_result.error_text;
@@ -56,11 +68,22 @@ void register_tool() {
         {"type", "string"},
         {"description", "The URL to navigate to (e.g. https://example.com)"}
     };
+    input_schema["properties"]["wait_until"] = {
+        {"type", "string"},
+        {"enum", {"commit", "DOMContentLoaded", "load", "networkIdle", "firstMeaningfulPaint"}},
+        {"description", "Optional. Return when the new page reaches this milestone. Default: return when the "
+                        "navigation has started."}
+    };
+    input_schema["properties"]["timeout_milliseconds"] = {
+        {"type", "integer"},
+        {"description", "Optional. Timeout for wait_until in ms (default 30000)."}
+    };
     input_schema["required"] = json::array({"url"});
 
     mcp_tools::register_tool({
         "navigate",
-        "Navigate the current browser tab to the specified URL. "
+        "Navigate the current browser tab to the specified URL. With wait_until, returns exactly when the page "
+        "reaches that lifecycle milestone. "
         "The browser must be open and a tab must be attached (call open_browser first).",
         input_schema,
         handle_navigate
@@ -12,9 +12,13 @@ static json handle_new_tab(const json &arguments) {
     if (arguments.contains("url") && arguments["url"].is_string()) {
         url = arguments["url"].get<std::string>();
     }
+    std::string browser_context_id;
+    if (arguments.contains("browser_context_id") && arguments["browser_context_id"].is_string()) {
+        browser_context_id = arguments["browser_context_id"].get<std::string>();
+    }
 
-    debug_log::log("new_tab invoked, url=" + url);
-    browser_driver::DriverResult driver_result = cdp_driver::new_tab(url);
+    debug_log::log("new_tab invoked, url=" + url + " browser_context_id=" + browser_context_id);
+    browser_driver::DriverResult driver_result = cdp_driver::new_tab(url, browser_context_id);
 
     json text_content;
     text_content["type"] = "text";
@@ -44,6 +48,10 @@ void register_tool() {
         {"type", "string"},
         {"description", "Optional URL to open in the new tab (default: about:blank)"}
     };
+    input_schema["properties"]["browser_context_id"] = {
+        {"type", "string"},
+        {"description", "Optional isolated context to open the tab in (from create_browser_context)"}
+    };
 
     mcp_tools::register_tool({
         "new_tab",
@@ -17,6 +17,9 @@ static json handle_open_browser(const json &arguments) {
     if (arguments.contains("disable_translate") && arguments["disable_translate"].is_boolean()) {
         options.disable_translate = arguments["disable_translate"].get<bool>();
     }
+    if (arguments.contains("new_instance") && arguments["new_instance"].is_boolean()) {
+        options.new_instance = arguments["new_instance"].get<bool>();
+    }
 
     debug_log::log("open_browser invoked");
     browser_driver::DriverResult driver_result = cdp_driver::open_browser(options);
@@ -54,6 +57,10 @@ void register_tool() {
         {"type", "boolean"},
         {"description", "If true, Chrome will not show the \"Would you like to translate this page?\" bar. Default true (bar hidden). Set to false to show the translate bar."}
     };
+    input_schema["properties"]["new_instance"] = {
+        {"type", "boolean"},
+        {"description", "If true and a browser is already open, launch an additional browser (own process and profile) in the pool and make it active. New tabs go to the least loaded browser; list_tabs shows tabs of all browsers. Default false."}
+    };
     input_schema["required"] = json::array();
 
     mcp_tools::register_tool({
@@ -84,7 +84,7 @@ void register_tool() {
     scroll_scope_props["type"] = json::object({{"type", "string"}, {"enum", type_enum}});
     scroll_scope_props["delta_x"] = json::object({{"type", "number"}, {"description", "Pixels to scroll horizontally. Default 0."}});
     scroll_scope_props["delta_y"] = json::object({{"type", "number"}, {"description", "Pixels to scroll vertically (positive = down). Default 0."}});
-    scroll_scope_props["selector"] = json::object({{"type", "string"}, {"description", "Required when type=element: CSS selector of the scrollable container."}});
+    scroll_scope_props["selector"] = json::object({{"type", "string"}, {"description", "Required when type=element: selector or element handle of the scrollable container."}});
 
     json scroll_scope_schema;
     scroll_scope_schema["type"] = "object";
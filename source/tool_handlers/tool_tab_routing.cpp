@@ -0,0 +1,113 @@
+#include "tool_handlers/tool_handlers.hpp"
+#include "mcp/mcp_tools.hpp"
+#include "browser/cdp/cdp_driver.hpp"
+#include "utils/debug_log.hpp"
+
+#include <nlohmann/json.hpp>
+#include <string>
+
+using json = nlohmann::json;
+
+// Optional tab_id / target_id argument shared by all page-level tools.
+// The call is routed to that tab's session without changing the current tab,
+// so several tabs can be driven without switch_tab round trips.
+
+// Tools that manage tabs or the browser itself keep their own semantics.
+static bool is_tab_routed_tool(const std::string &tool_name) {
+    return tool_name != "open_browser" && tool_name != "close_browser" &&
+           tool_name != "list_tabs" && tool_name != "new_tab" &&
+           tool_name != "switch_tab" && tool_name != "close_tab" &&
+           tool_name != "create_browser_context" && tool_name != "dispose_browser_context";
+}
+
+// Ends a route_to_tab when the routed call returns or throws, so a failing handler cannot leave
+// later untargeted calls on the routed tab (or browser).
+struct TabRouteReset {
+    ~TabRouteReset() {
+        std::string reset_error;
+        cdp_driver::route_to_tab("", reset_error);
+    }
+};
+
+static json make_error_result(const std::string &text) {
+    json error_content;
+    error_content["type"] = "text";
+    error_content["text"] = text;
+
+    json result;
+    result["content"] = json::array({error_content});
+    result["isError"] = true;
+    return result;
+}
+
+// Read tab_id (target id string or list_tabs index) or target_id. Empty = current tab.
+static bool read_tab_argument(const json &arguments, std::string &out_tab_id, std::string &out_error) {
+    out_tab_id.clear();
+    if (!arguments.is_object()) {
+        return true;
+    }
+    if (arguments.contains("target_id") && !arguments["target_id"].is_null()) {
+        if (!arguments["target_id"].is_string()) {
+            out_error = "'target_id' must be a string (from list_tabs).";
+            return false;
+        }
+        out_tab_id = arguments["target_id"].get<std::string>();
+        return true;
+    }
+    if (arguments.contains("tab_id") && !arguments["tab_id"].is_null()) {
+        if (arguments["tab_id"].is_string()) {
+            out_tab_id = arguments["tab_id"].get<std::string>();
+        } else if (arguments["tab_id"].is_number_integer() && arguments["tab_id"].get<int>() >= 0) {
+            out_tab_id = std::to_string(arguments["tab_id"].get<int>());
+        } else {
+            out_error = "'tab_id' must be a target id string or a 0-based tab index (from list_tabs).";
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace tool_tab_routing {
+
+void apply_to_registered_tools() {
+    mcp_tools::transform_tools([](mcp_tools::ToolDefinition &tool) {
+        if (!is_tab_routed_tool(tool.name)) {
+            return;
+        }
+
+        if (!tool.input_schema.contains("properties") || !tool.input_schema["properties"].is_object()) {
+            tool.input_schema["properties"] = json::object();
+        }
+        tool.input_schema["properties"]["tab_id"] = {
+            {"type", {"string", "integer"}},
+            {"description", "Optional. Run on this tab (target id or 0-based index from list_tabs) "
+                            "without switching the current tab."}
+        };
+        tool.input_schema["properties"]["target_id"] = {
+            {"type", "string"},
+            {"description", "Optional. Same as tab_id, by target id only."}
+        };
+
+        std::string tool_name = tool.name;
+        mcp_tools::ToolHandler inner_handler = tool.handler;
+        tool.handler = [tool_name, inner_handler](const json &arguments) -> json {
+            std::string tab_id;
+            std::string error_text;
+            if (!read_tab_argument(arguments, tab_id, error_text)) {
+                return make_error_result(tool_name + ": " + error_text);
+            }
+            if (tab_id.empty()) {
+                return inner_handler(arguments);
+            }
+
+            debug_log::log(tool_name + " routed to tab " + tab_id);
+            TabRouteReset route_reset;
+            if (!cdp_driver::route_to_tab(tab_id, error_text)) {
+                return make_error_result(tool_name + " failed: " + error_text);
+            }
+            return inner_handler(arguments);
+        };
+    });
+}
+
+} // namespace tool_tab_routing
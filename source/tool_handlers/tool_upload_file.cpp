@@ -60,7 +60,7 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = {
-        {"selector", {{"type", "string"}, {"description", "CSS selector of the file input."}}},
+        {"selector", {{"type", "string"}, {"description", "Selector or element handle of the file input."}}},
         {"file_path", {{"type", "string"}, {"description", "Absolute path to the file."}}}
     };
     input_schema["required"] = json::array({"selector", "file_path"});
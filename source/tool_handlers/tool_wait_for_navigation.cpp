@@ -14,9 +14,13 @@ static json handle_wait_for_navigation(const json &arguments) {
     if (arguments.contains("timeout_milliseconds") && arguments["timeout_milliseconds"].is_number_integer()) {
         timeout_milliseconds = arguments["timeout_milliseconds"].get<int>();
     }
+    std::string wait_until = "load";
+    if (arguments.contains("wait_until") && arguments["wait_until"].is_string()) {
+        wait_until = arguments["wait_until"].get<std::string>();
+    }
 
-    debug_log::log("wait_for_navigation invoked");
-    browser_driver::DriverResult wait_result = cdp_driver::wait_for_navigation(timeout_milliseconds);
+    debug_log::log("wait_for_navigation invoked wait_until=" + wait_until);
+    browser_driver::DriverResult wait_result = cdp_driver::wait_for_navigation(timeout_milliseconds, wait_until);
 
     if (!wait_result.success) {
         json error_content;
@@ -43,12 +47,17 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = {
+        {"wait_until", {{"type", "string"},
+                        {"enum", {"commit", "DOMContentLoaded", "load", "networkIdle", "firstMeaningfulPaint"}},
+                        {"description", "Lifecycle milestone of the current page to wait for (default load)."}}},
         {"timeout_milliseconds", {{"type", "integer"}, {"description", "Timeout in ms (default 10000)."}}}
     };
 
     mcp_tools::register_tool({
         "wait_for_navigation",
-        "Wait until document.readyState is complete. Browser must be open and a tab attached.",
+        "Wait until the current page reaches a lifecycle milestone (default load; also commit, DOMContentLoaded, "
+        "networkIdle, firstMeaningfulPaint). Event-driven, returns when the milestone fires. "
+        "Browser must be open and a tab attached.",
         input_schema,
         handle_wait_for_navigation
     });
@@ -0,0 +1,75 @@
+#include "tool_handlers/tool_handlers.hpp"
+#include "mcp/mcp_tools.hpp"
+#include "browser/cdp/cdp_driver.hpp"
+#include "utils/debug_log.hpp"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+using json = nlohmann::json;
+
+static json handle_wait_for_network_idle(const json &arguments) {
+    json result;
+
+    int idle_milliseconds = 500;
+    if (arguments.contains("idle_milliseconds") && arguments["idle_milliseconds"].is_number_integer()) {
+        idle_milliseconds = std::max(0, arguments["idle_milliseconds"].get<int>());
+    }
+    int max_inflight = 0;
+    if (arguments.contains("max_inflight") && arguments["max_inflight"].is_number_integer()) {
+        max_inflight = std::max(0, arguments["max_inflight"].get<int>());
+    }
+    int timeout_milliseconds = 30000;
+    if (arguments.contains("timeout_milliseconds") && arguments["timeout_milliseconds"].is_number_integer()) {
+        timeout_milliseconds = arguments["timeout_milliseconds"].get<int>();
+    }
+
+    debug_log::log("wait_for_network_idle invoked idle_ms=" + std::to_string(idle_milliseconds) +
+                   " max_inflight=" + std::to_string(max_inflight));
+    browser_driver::DriverResult wait_result =
+        cdp_driver::wait_for_network_idle(idle_milliseconds, max_inflight, timeout_milliseconds);
+
+    if (!wait_result.success) {
+        json error_content;
+        error_content["type"] = "text";
+        error_content["text"] = "wait_for_network_idle failed: " + wait_result.error_detail;
+
+        result["content"] = json::array({error_content});
+        result["isError"] = true;
+        return result;
+    }
+
+    json text_content;
+    text_content["type"] = "text";
+    text_content["text"] = wait_result.message;
+
+    result["content"] = json::array({text_content});
+    result["isError"] = false;
+    return result;
+}
+
+namespace tool_wait_for_network_idle {
+
+void register_tool() {
+    json input_schema;
+    input_schema["type"] = "object";
+    input_schema["properties"] = {
+        {"idle_milliseconds", {{"type", "integer"},
+                               {"description", "Quiet period with no request starting or finishing (default 500)."}}},
+        {"max_inflight", {{"type", "integer"},
+                          {"description", "Requests allowed to stay in flight, e.g. 2 to tolerate long polling "
+                                          "(default 0)."}}},
+        {"timeout_milliseconds", {{"type", "integer"}, {"description", "Timeout in ms (default 30000)."}}}
+    };
+
+    mcp_tools::register_tool({
+        "wait_for_network_idle",
+        "Wait until the page's network is idle: at most max_inflight requests in flight and none started or "
+        "finished for idle_milliseconds. Event-driven from the Network domain (enabled on first use). On timeout "
+        "the error names requests still in flight. Browser must be open and a tab attached.",
+        input_schema,
+        handle_wait_for_network_idle
+    });
+}
+
+} // namespace tool_wait_for_network_idle
@@ -25,9 +25,13 @@ static json handle_wait_for_selector(const json &arguments) {
     if (arguments.contains("timeout_milliseconds") && arguments["timeout_milliseconds"].is_number_integer()) {
         timeout_milliseconds = arguments["timeout_milliseconds"].get<int>();
     }
+    std::string state = "attached";
+    if (arguments.contains("state") && arguments["state"].is_string()) {
+        state = arguments["state"].get<std::string>();
+    }
 
-    debug_log::log("wait_for_selector invoked");
-    browser_driver::DriverResult wait_result = cdp_driver::wait_for_selector(selector, timeout_milliseconds);
+    debug_log::log("wait_for_selector invoked state=" + state);
+    browser_driver::DriverResult wait_result = cdp_driver::wait_for_selector(selector, timeout_milliseconds, state);
 
     if (!wait_result.success) {
         json error_content;
@@ -54,14 +58,18 @@ void register_tool() {
     json input_schema;
     input_schema["type"] = "object";
     input_schema["properties"] = {
-        {"selector", {{"type", "string"}, {"description", "CSS selector to wait for."}}},
+        {"selector", {{"type", "string"}, {"description", "Selector or element handle to wait for."}}},
+        {"state", {{"type", "string"},
+                   {"enum", {"attached", "detached", "visible", "hidden", "enabled"}},
+                   {"description", "State to wait for (default attached: present in the DOM)."}}},
         {"timeout_milliseconds", {{"type", "integer"}, {"description", "Timeout in ms (default 5000)."}}}
     };
     input_schema["required"] = json::array({"selector"});
 
     mcp_tools::register_tool({
         "wait_for_selector",
-        "Wait until an element matching the selector appears. Browser must be open and a tab attached.",
+        "Wait until an element matching the selector is attached (default), detached, visible, hidden or enabled. "
+        "Returns as soon as the page changes (no polling). Browser must be open and a tab attached.",
         input_schema,
         handle_wait_for_selector
     });
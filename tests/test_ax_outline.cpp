@@ -0,0 +1,142 @@
+// Tests for the accessibility outline formatter (cdp_ax_outline).
+// Feeds hand-written Accessibility.getFullAXTree nodes, no browser needed.
+
+#include "browser/cdp/cdp_ax_outline.hpp"
+
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+using json = nlohmann::json;
+
+namespace test_ax_outline {
+
+static json ax_node(const std::string &node_id, const std::string &role, const std::string &name,
+                    const json &child_ids, int backend_node_id, bool ignored = false) {
+    json node;
+    node["nodeId"] = node_id;
+    node["ignored"] = ignored;
+    node["role"] = {{"type", "role"}, {"value", role}};
+    if (!name.empty()) {
+        node["name"] = {{"type", "computedString"}, {"value", name}};
+    }
+    node["childIds"] = child_ids;
+    node["backendDOMNodeId"] = backend_node_id;
+    return node;
+}
+
+// RootWebArea > generic (unnamed) > [button "Save" > StaticText "Save", ignored > StaticText "Hello"]
+static json sample_tree() {
+    json nodes = json::array();
+    nodes.push_back(ax_node("1", "RootWebArea", "Page", {"2"}, 1));
+    nodes.push_back(ax_node("2", "generic", "", {"3", "5"}, 2));
+    json button = ax_node("3", "button", "Save", {"4"}, 3);
+    button["properties"] = json::array({{{"name", "disabled"}, {"value", {{"type", "boolean"}, {"value", true}}}}});
+    nodes.push_back(button);
+    nodes.push_back(ax_node("4", "StaticText", "Save", json::array(), 4));
+    nodes.push_back(ax_node("5", "paragraph", "", {"6"}, 5, true));
+    nodes.push_back(ax_node("6", "StaticText", "Hello", json::array(), 6));
+    return nodes;
+}
+
+// Test: pruning lifts children of unnamed/ignored nodes and drops text repeating the parent's name.
+static bool test_outline_prunes_nodes() {
+    cdp_ax_outline::AxOutline outline = cdp_ax_outline::format_ax_outline(sample_tree());
+    std::string expected =
+        "- RootWebArea \"Page\"\n"
+        "  - button \"Save\" [disabled] @n3\n"
+        "  - text \"Hello\"\n";
+    bool success = outline.root_found && outline.text == expected && outline.line_count == 3 && !outline.truncated;
+
+    if (success) {
+        std::cout << "  OK: Outline prunes ignored/generic nodes and repeated text" << std::endl;
+    } else {
+        std::cout << "  FAIL: Outline was:\n" << outline.text << std::endl;
+    }
+    return success;
+}
+
+// Test: root_backend_node_id scopes the outline to a subtree.
+static bool test_outline_subtree() {
+    cdp_ax_outline::AxOutlineOptions options;
+    options.root_backend_node_id = 3;
+    cdp_ax_outline::AxOutline outline = cdp_ax_outline::format_ax_outline(sample_tree(), options);
+    bool success = outline.root_found && outline.text == "- button \"Save\" [disabled] @n3\n";
+
+    if (success) {
+        std::cout << "  OK: Outline can be scoped to a subtree" << std::endl;
+    } else {
+        std::cout << "  FAIL: Subtree outline was:\n" << outline.text << std::endl;
+    }
+    return success;
+}
+
+// Test: the viewport filter keeps visible nodes and their ancestors only.
+static bool test_outline_viewport_filter() {
+    std::unordered_set<int> visible = {6};
+    cdp_ax_outline::AxOutlineOptions options;
+    options.visible_backend_node_ids = &visible;
+    cdp_ax_outline::AxOutline outline = cdp_ax_outline::format_ax_outline(sample_tree(), options);
+    bool success = outline.text == "- RootWebArea \"Page\"\n  - text \"Hello\"\n";
+
+    if (success) {
+        std::cout << "  OK: Viewport filter keeps visible nodes and ancestors" << std::endl;
+    } else {
+        std::cout << "  FAIL: Filtered outline was:\n" << outline.text << std::endl;
+    }
+    return success;
+}
+
+// Test: max_lines stops the outline and reports truncation.
+static bool test_outline_max_lines() {
+    cdp_ax_outline::AxOutlineOptions options;
+    options.max_lines = 2;
+    cdp_ax_outline::AxOutline outline = cdp_ax_outline::format_ax_outline(sample_tree(), options);
+    bool success = outline.line_count == 2 && outline.truncated;
+
+    if (success) {
+        std::cout << "  OK: Outline stops at max_lines" << std::endl;
+    } else {
+        std::cout << "  FAIL: line_count=" << outline.line_count << " truncated=" << outline.truncated << std::endl;
+    }
+    return success;
+}
+
+// Test: names are cut at max_name_length characters, never inside a multi-byte character.
+static bool test_outline_multibyte_name() {
+    std::string name;
+    for (int index = 0; index < 50; ++index) {
+        name += "\xD0\x96";  // U+0416
+    }
+    json nodes = json::array({ax_node("1", "button", name, json::array(), 1)});
+    cdp_ax_outline::AxOutlineOptions options;
+    options.max_name_length = 41;
+    cdp_ax_outline::AxOutline outline = cdp_ax_outline::format_ax_outline(nodes, options);
+    std::string expected = "- button \"" + name.substr(0, 82) + "...\" @n1\n";
+    bool success = outline.text == expected;
+    try {
+        json(outline.text).dump();
+    } catch (const std::exception &) {
+        success = false;
+    }
+
+    if (success) {
+        std::cout << "  OK: Long multi-byte names are cut on character boundaries" << std::endl;
+    } else {
+        std::cout << "  FAIL: Multi-byte outline was:\n" << outline.text << std::endl;
+    }
+    return success;
+}
+
+bool run_all_tests() {
+    bool all_passed = true;
+    all_passed &= test_outline_prunes_nodes();
+    all_passed &= test_outline_subtree();
+    all_passed &= test_outline_viewport_filter();
+    all_passed &= test_outline_max_lines();
+    all_passed &= test_outline_multibyte_name();
+    return all_passed;
+}
+
+} // namespace test_ax_outline
@@ -0,0 +1,198 @@
+// Tests for interactive-element extraction from DOMSnapshot data (cdp_dom_snapshot).
+// Feeds hand-built DOMSnapshot.captureSnapshot results, no browser needed.
+
+#include "browser/cdp/cdp_dom_snapshot.hpp"
+
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace test_dom_snapshot {
+
+// Builds a captureSnapshot result: one shared string table, documents with flat node arrays.
+struct SnapshotBuilder {
+    json snapshot = {{"documents", json::array()}, {"strings", json::array()}};
+
+    int string_index(const std::string &text) {
+        json &strings = snapshot["strings"];
+        for (size_t index = 0; index < strings.size(); ++index) {
+            if (strings[index] == text) {
+                return static_cast<int>(index);
+            }
+        }
+        strings.push_back(text);
+        return static_cast<int>(strings.size()) - 1;
+    }
+
+    int add_document() {
+        json document;
+        document["nodes"] = {{"parentIndex", json::array()}, {"nodeType", json::array()},
+                             {"nodeName", json::array()},    {"nodeValue", json::array()},
+                             {"backendNodeId", json::array()}, {"attributes", json::array()}};
+        document["layout"] = {{"nodeIndex", json::array()}, {"bounds", json::array()}, {"styles", json::array()}};
+        snapshot["documents"].push_back(document);
+        return static_cast<int>(snapshot["documents"].size()) - 1;
+    }
+
+    // Adds a node; a non-empty box gives it a layout object. Returns its node index.
+    int add_node(int document_index, int parent, int node_type, const std::string &name, const std::string &value,
+                 const std::vector<std::string> &attributes = {}, const std::vector<double> &box = {}) {
+        json &document = snapshot["documents"][document_index];
+        json &nodes = document["nodes"];
+        int node = static_cast<int>(nodes["nodeType"].size());
+        nodes["parentIndex"].push_back(parent);
+        nodes["nodeType"].push_back(node_type);
+        nodes["nodeName"].push_back(string_index(name));
+        nodes["nodeValue"].push_back(value.empty() ? -1 : string_index(value));
+        nodes["backendNodeId"].push_back(document_index * 1000 + node + 1);
+        json flat = json::array();
+        for (const auto &attribute : attributes) {
+            flat.push_back(string_index(attribute));
+        }
+        nodes["attributes"].push_back(flat);
+        if (!box.empty()) {
+            document["layout"]["nodeIndex"].push_back(node);
+            document["layout"]["bounds"].push_back(box);
+            document["layout"]["styles"].push_back(json::array({string_index("visible")}));
+        }
+        return node;
+    }
+
+    int add_element(int document_index, int parent, const std::string &name,
+                    const std::vector<std::string> &attributes = {}, const std::vector<double> &box = {0, 0, 100, 20}) {
+        return add_node(document_index, parent, 1, name, "", attributes, box);
+    }
+
+    // Rendered text node (laid out inside its parent) unless rendered is false.
+    int add_text(int document_index, int parent, const std::string &text, bool rendered = true) {
+        return add_node(document_index, parent, 3, "#text", text, {},
+                        rendered ? std::vector<double>{0, 0, 10, 10} : std::vector<double>{});
+    }
+};
+
+// Test: long multi-byte text is capped on a character boundary, so it stays valid for JSON.
+static bool test_multibyte_text_cap() {
+    SnapshotBuilder builder;
+    int document = builder.add_document();
+    int body = builder.add_element(document, -1, "BODY");
+    int button = builder.add_element(document, body, "BUTTON");
+    std::string text;
+    for (int index = 0; index < 100; ++index) {
+        text += "\xE4\xB8\xAD";  // U+4E2D
+    }
+    builder.add_text(document, button, text);
+
+    std::vector<cdp_dom_snapshot::SnapshotElement> elements =
+        cdp_dom_snapshot::extract_interactive_elements(builder.snapshot, 800, 600);
+    bool success = elements.size() == 1 && !elements[0].element.text.empty() &&
+                   elements[0].element.text.size() < text.size() && elements[0].element.text.size() % 3 == 0 &&
+                   text.compare(0, elements[0].element.text.size(), elements[0].element.text) == 0;
+    try {
+        json(elements.empty() ? "" : elements[0].element.text).dump();
+    } catch (const std::exception &) {
+        success = false;
+    }
+
+    if (success) {
+        std::cout << "  OK: Element text is capped on UTF-8 character boundaries" << std::endl;
+    } else {
+        std::cout << "  FAIL: Capped text has " << (elements.empty() ? 0 : elements[0].element.text.size())
+                  << " bytes" << std::endl;
+    }
+    return success;
+}
+
+// Test: labels come from <label for=id> and from a wrapping <label>.
+static bool test_label_resolution() {
+    SnapshotBuilder builder;
+    int document = builder.add_document();
+    int body = builder.add_element(document, -1, "BODY");
+    int for_label = builder.add_element(document, body, "LABEL", {"for", "email"});
+    builder.add_text(document, for_label, "  E-mail\n address ");
+    builder.add_element(document, body, "INPUT", {"id", "email", "type", "email"});
+    int wrapping_label = builder.add_element(document, body, "LABEL");
+    builder.add_text(document, wrapping_label, "Name");
+    builder.add_element(document, wrapping_label, "INPUT");
+
+    std::vector<cdp_dom_snapshot::SnapshotElement> elements =
+        cdp_dom_snapshot::extract_interactive_elements(builder.snapshot, 800, 600);
+    bool success = elements.size() == 2 && elements[0].element.label == "E-mail address" &&
+                   elements[0].element.type == "email" && elements[1].element.label == "Name" &&
+                   elements[1].element.type == "text";
+
+    if (success) {
+        std::cout << "  OK: Labels resolve through for= and wrapping labels" << std::endl;
+    } else {
+        std::cout << "  FAIL: Got " << elements.size() << " elements, labels '"
+                  << (elements.size() > 0 ? elements[0].element.label : "") << "' / '"
+                  << (elements.size() > 1 ? elements[1].element.label : "") << "'" << std::endl;
+    }
+    return success;
+}
+
+// Test: options of a closed <select> (no layout) are listed with their text when the select is visible.
+static bool test_closed_select_options() {
+    SnapshotBuilder builder;
+    int document = builder.add_document();
+    int body = builder.add_element(document, -1, "BODY");
+    int select = builder.add_element(document, body, "SELECT");
+    int option = builder.add_element(document, select, "OPTION", {"value", "r"}, {});
+    builder.add_text(document, option, "Red", false);
+    int hidden_select = builder.add_element(document, body, "SELECT", {}, {});
+    int hidden_option = builder.add_element(document, hidden_select, "OPTION", {}, {});
+    builder.add_text(document, hidden_option, "Blue", false);
+
+    std::vector<cdp_dom_snapshot::SnapshotElement> elements =
+        cdp_dom_snapshot::extract_interactive_elements(builder.snapshot, 800, 600);
+    bool success = elements.size() == 1 && elements[0].element.role == "option" && elements[0].element.text == "Red";
+
+    if (success) {
+        std::cout << "  OK: Closed select options inherit the select's visibility" << std::endl;
+    } else {
+        std::cout << "  FAIL: Got " << elements.size() << " option elements" << std::endl;
+    }
+    return success;
+}
+
+// Test: iframe content is offset by the frame element's box (and the frame's scroll) for the viewport check.
+static bool test_iframe_origin_offset() {
+    SnapshotBuilder builder;
+    int top = builder.add_document();
+    int body = builder.add_element(top, -1, "BODY");
+    int frame = builder.add_element(top, body, "IFRAME", {}, {100, 500, 400, 300});
+    int child = builder.add_document();
+    builder.snapshot["documents"][top]["nodes"]["contentDocumentIndex"] = {{"index", json::array({frame})},
+                                                                           {"value", json::array({child})}};
+    builder.snapshot["documents"][child]["scrollOffsetY"] = 20.0;
+    int child_body = builder.add_element(child, -1, "BODY");
+    builder.add_element(child, child_body, "BUTTON", {"id", "near"}, {10, 30, 50, 20});   // top 510
+    builder.add_element(child, child_body, "BUTTON", {"id", "far"}, {10, 130, 50, 20});   // top 610
+
+    std::vector<cdp_dom_snapshot::SnapshotElement> elements =
+        cdp_dom_snapshot::extract_interactive_elements(builder.snapshot, 800, 600);
+    std::unordered_set<int> visible = cdp_dom_snapshot::backend_node_ids_in_viewport(builder.snapshot, 800, 600);
+    bool success = elements.size() == 2 && elements[0].in_viewport && !elements[1].in_viewport &&
+                   visible.count(elements[0].backend_node_id) == 1 &&
+                   visible.count(elements[1].backend_node_id) == 0;
+
+    if (success) {
+        std::cout << "  OK: Iframe elements are offset by the frame box and scroll" << std::endl;
+    } else {
+        std::cout << "  FAIL: Iframe viewport flags wrong (" << elements.size() << " elements)" << std::endl;
+    }
+    return success;
+}
+
+bool run_all_tests() {
+    bool all_passed = true;
+    all_passed &= test_multibyte_text_cap();
+    all_passed &= test_label_resolution();
+    all_passed &= test_closed_select_options();
+    all_passed &= test_iframe_origin_offset();
+    return all_passed;
+}
+
+} // namespace test_dom_snapshot
@@ -15,6 +15,18 @@ namespace test_navigate {
     bool run_all_tests();
 }
 
+namespace test_ax_outline {
+    bool run_all_tests();
+}
+
+namespace test_dom_snapshot {
+    bool run_all_tests();
+}
+
+namespace test_screenshot_diff {
+    bool run_all_tests();
+}
+
 struct TestSuite {
     std::string name;
     std::function<bool()> runner;
@@ -24,6 +36,9 @@ int main() {
     std::vector<TestSuite> suites = {
         {"test_open_browser", test_open_browser::run_all_tests},
         {"test_navigate", test_navigate::run_all_tests},
+        {"test_ax_outline", test_ax_outline::run_all_tests},
+        {"test_dom_snapshot", test_dom_snapshot::run_all_tests},
+        {"test_screenshot_diff", test_screenshot_diff::run_all_tests},
     };
 
     int passed_count = 0;
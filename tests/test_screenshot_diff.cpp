@@ -0,0 +1,191 @@
+// Tests for screenshot change detection (cdp_screenshot_diff).
+// PNGs are built in memory with zlib, no browser needed.
+
+#include "browser/cdp/cdp_screenshot_diff.hpp"
+
+#include <zlib.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace test_screenshot_diff {
+
+static void append_be32(std::string &out, uint32_t value) {
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+static void append_chunk(std::string &out, const char *type, const std::string &data) {
+    append_be32(out, static_cast<uint32_t>(data.size()));
+    std::string body = std::string(type, 4) + data;
+    out += body;
+    append_be32(out, static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef *>(body.data()),
+                                                 static_cast<uInt>(body.size()))));
+}
+
+// RGB PNG of width x height; row y uses filter y % 5, so every filter type is decoded.
+static std::string make_png(int width, int height, const std::vector<unsigned char> &rgb) {
+    std::string raw;
+    size_t stride = static_cast<size_t>(width) * 3;
+    for (int y = 0; y < height; ++y) {
+        int filter = y % 5;
+        raw.push_back(static_cast<char>(filter));
+        const unsigned char *row = rgb.data() + y * stride;
+        const unsigned char *up_row = y > 0 ? row - stride : nullptr;
+        for (size_t index = 0; index < stride; ++index) {
+            int left = index >= 3 ? row[index - 3] : 0;
+            int up = up_row ? up_row[index] : 0;
+            int up_left = up_row && index >= 3 ? up_row[index - 3] : 0;
+            int predictor = 0;
+            if (filter == 1) {
+                predictor = left;
+            } else if (filter == 2) {
+                predictor = up;
+            } else if (filter == 3) {
+                predictor = (left + up) >> 1;
+            } else if (filter == 4) {
+                int estimate = left + up - up_left;
+                int distance_left = std::abs(estimate - left);
+                int distance_up = std::abs(estimate - up);
+                int distance_up_left = std::abs(estimate - up_left);
+                predictor = (distance_left <= distance_up && distance_left <= distance_up_left) ? left
+                            : distance_up <= distance_up_left                                 ? up
+                                                                                               : up_left;
+            }
+            raw.push_back(static_cast<char>(row[index] - predictor));
+        }
+    }
+    std::vector<unsigned char> compressed(compressBound(static_cast<uLong>(raw.size())));
+    uLongf compressed_size = static_cast<uLongf>(compressed.size());
+    compress(compressed.data(), &compressed_size, reinterpret_cast<const Bytef *>(raw.data()),
+             static_cast<uLong>(raw.size()));
+
+    std::string png = "\x89PNG\r\n\x1A\n";
+    std::string header;
+    append_be32(header, static_cast<uint32_t>(width));
+    append_be32(header, static_cast<uint32_t>(height));
+    header += std::string("\x08\x02\x00\x00\x00", 5);  // 8-bit RGB, no interlace
+    append_chunk(png, "IHDR", header);
+    append_chunk(png, "IDAT", std::string(reinterpret_cast<const char *>(compressed.data()), compressed_size));
+    append_chunk(png, "IEND", "");
+    return png;
+}
+
+static std::vector<unsigned char> gradient(int width, int height) {
+    std::vector<unsigned char> rgb(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            unsigned char *pixel = rgb.data() + (static_cast<size_t>(y) * width + x) * 3;
+            pixel[0] = static_cast<unsigned char>(x * 7 + y);
+            pixel[1] = static_cast<unsigned char>(y * 13);
+            pixel[2] = static_cast<unsigned char>((x ^ y) * 5);
+        }
+    }
+    return rgb;
+}
+
+// Test: all five row filters decode back to the original pixels.
+static bool test_decode_png_filters() {
+    const int width = 23;
+    const int height = 17;
+    std::vector<unsigned char> rgb = gradient(width, height);
+    cdp_screenshot_diff::Image image;
+    std::string error;
+    bool success = cdp_screenshot_diff::decode_png(make_png(width, height, rgb), image, error) &&
+                   image.width == width && image.height == height;
+    for (size_t index = 0; success && index < image.pixels.size(); ++index) {
+        const unsigned char *pixel = reinterpret_cast<const unsigned char *>(&image.pixels[index]);
+        success = pixel[0] == rgb[index * 3] && pixel[1] == rgb[index * 3 + 1] && pixel[2] == rgb[index * 3 + 2] &&
+                  pixel[3] == 0xFF;
+    }
+
+    if (success) {
+        std::cout << "  OK: PNG decode handles every row filter" << std::endl;
+    } else {
+        std::cout << "  FAIL: PNG decode mismatch " << error << std::endl;
+    }
+    return success;
+}
+
+// Test: base64 decoding of CDP data (with padding).
+static bool test_decode_base64() {
+    std::string bytes;
+    bool success = cdp_screenshot_diff::decode_base64("aGVsbG8gd29ybGQ=", bytes) && bytes == "hello world" &&
+                   !cdp_screenshot_diff::decode_base64("aGVs*G8=", bytes);
+
+    if (success) {
+        std::cout << "  OK: base64 decode" << std::endl;
+    } else {
+        std::cout << "  FAIL: base64 decoded to '" << bytes << "'" << std::endl;
+    }
+    return success;
+}
+
+// Test: a crop encoded with encode_png decodes to the same pixels; base64 round-trips it.
+static bool test_encode_png_crop() {
+    cdp_screenshot_diff::Image image;
+    image.width = 40;
+    image.height = 30;
+    for (int index = 0; index < 40 * 30; ++index) {
+        image.pixels.push_back(static_cast<uint32_t>(index * 2654435761u));
+    }
+    cdp_screenshot_diff::Region region{8, 5, 20, 50};  // height clamped to the image
+    std::string png = cdp_screenshot_diff::encode_png(image, region);
+    std::string bytes;
+    cdp_screenshot_diff::Image crop;
+    std::string error;
+    bool success = cdp_screenshot_diff::decode_base64(cdp_screenshot_diff::encode_base64(png), bytes) &&
+                   bytes == png && cdp_screenshot_diff::decode_png(png, crop, error) && crop.width == 20 &&
+                   crop.height == 25;
+    for (int y = 0; success && y < crop.height; ++y) {
+        for (int x = 0; success && x < crop.width; ++x) {
+            success = crop.pixels[y * 20 + x] == image.pixels[(y + 5) * 40 + x + 8];
+        }
+    }
+
+    if (success) {
+        std::cout << "  OK: Crops encode to PNG and decode back unchanged" << std::endl;
+    } else {
+        std::cout << "  FAIL: Crop round trip " << error << std::endl;
+    }
+    return success;
+}
+
+// Test: identical images have no regions; separate changes give separate tile-aligned boxes.
+static bool test_changed_regions() {
+    cdp_screenshot_diff::Image previous;
+    previous.width = 100;
+    previous.height = 80;
+    previous.pixels.assign(100 * 80, 0xFFFFFFFF);
+    cdp_screenshot_diff::Image current = previous;
+    bool success = cdp_screenshot_diff::changed_regions(previous, current, 16).empty();
+
+    current.pixels[5 * 100 + 5] = 0;    // tile (0, 0)
+    current.pixels[20 * 100 + 20] = 0;  // tile (1, 1): diagonal neighbour, same group
+    current.pixels[70 * 100 + 99] = 0;  // tile (6, 4): right edge, clipped to the image
+    std::vector<cdp_screenshot_diff::Region> regions = cdp_screenshot_diff::changed_regions(previous, current, 16);
+    success = success && regions.size() == 2 && regions[0].x == 0 && regions[0].y == 0 && regions[0].width == 32 &&
+              regions[0].height == 32 && regions[1].x == 96 && regions[1].y == 64 && regions[1].width == 4 &&
+              regions[1].height == 16;
+
+    if (success) {
+        std::cout << "  OK: Changed tiles are grouped into bounding boxes" << std::endl;
+    } else {
+        std::cout << "  FAIL: Got " << regions.size() << " regions" << std::endl;
+    }
+    return success;
+}
+
+bool run_all_tests() {
+    bool all_passed = true;
+    all_passed &= test_decode_png_filters();
+    all_passed &= test_decode_base64();
+    all_passed &= test_encode_png_crop();
+    all_passed &= test_changed_regions();
+    return all_passed;
+}
+
+} // namespace test_screenshot_diff